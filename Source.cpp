@@ -1,10 +1,145 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <queue>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <sstream>
+#include <fstream>
+#include <set>
+#include <tuple>
+#include <iterator>
+#include <charconv>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <ctime>
+#endif
 using namespace std;
 
+// Interned string id. Equal strings always get the same symbol, so comparing
+// two symbols is a single integer compare.
+typedef uint32_t Symbol;
+
+// Global pool for the strings repeated across every course, room, student and
+// club record. Text is copied once into arena blocks that never move, so the
+// string_views handed out stay valid for the life of the program. The views
+// live in fixed-size chunks that are never reallocated either, so text() is a
+// plain read and only intern() takes the lock.
+class SymbolTable {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t MAX_CHUNKS = 1024; // Room for a million symbols
+
+    vector<unique_ptr<char[]>> blocks;
+    char* cursor;
+    size_t remaining;
+    unique_ptr<atomic<string_view*>[]> chunks;
+    atomic<size_t> count;
+    unordered_map<string_view, Symbol> lookup;
+    mutex tableMutex;
+
+    string_view store(string_view text) {
+        if (text.size() > remaining) {
+            size_t blockSize = max(BLOCK_SIZE, text.size());
+            blocks.push_back(unique_ptr<char[]>(new char[blockSize]));
+            cursor = blocks.back().get();
+            remaining = blockSize;
+        }
+        char* destination = cursor;
+        text.copy(destination, text.size());
+        cursor += text.size();
+        remaining -= text.size();
+        return string_view(destination, text.size());
+    }
+
+    SymbolTable() {
+        this->cursor = nullptr;
+        this->remaining = 0;
+        this->chunks.reset(new atomic<string_view*>[MAX_CHUNKS]());
+        this->count.store(0, memory_order_relaxed);
+    }
+
+    ~SymbolTable() {
+        for (size_t i = 0; i < MAX_CHUNKS; i++) {
+            delete[] chunks[i].load(memory_order_relaxed);
+        }
+    }
+
+public:
+    static SymbolTable& global() {
+        static SymbolTable table;
+        return table;
+    }
+
+    Symbol intern(string_view text) {
+        lock_guard<mutex> lock(tableMutex);
+        auto found = lookup.find(text);
+        if (found != lookup.end()) {
+            return found->second;
+        }
+
+        size_t next = count.load(memory_order_relaxed);
+        if (next >= CHUNK_SIZE * MAX_CHUNKS) {
+            cerr << "Symbol table full" << endl;
+            abort();
+        }
+        string_view* chunk = chunks[next / CHUNK_SIZE].load(memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new string_view[CHUNK_SIZE];
+            chunks[next / CHUNK_SIZE].store(chunk, memory_order_release);
+        }
+
+        Symbol symbol = static_cast<Symbol>(next);
+        string_view stored = store(text);
+        chunk[next % CHUNK_SIZE] = stored;
+        lookup[stored] = symbol;
+        count.store(next + 1, memory_order_release);
+        return symbol;
+    }
+
+    // Lock-free: a symbol is only handed out after its slot is written, and
+    // neither the chunk nor the text it points at ever moves.
+    string_view text(Symbol symbol) const {
+        return chunks[symbol / CHUNK_SIZE].load(memory_order_acquire)[symbol % CHUNK_SIZE];
+    }
+
+    size_t size() const {
+        return count.load(memory_order_acquire);
+    }
+};
+
+Symbol intern(string_view text) {
+    return SymbolTable::global().intern(text);
+}
+
+string_view symbolText(Symbol symbol) {
+    return SymbolTable::global().text(symbol);
+}
+
 // Forward declarations
 class Student;
 class Room;
@@ -13,8 +148,8 @@ class Course;
 class Course {
 private:
     int courseCode;
-    string name;
-    string requiredRoom;
+    Symbol name;
+    Symbol requiredRoom;
     int maxCapacity;
     vector<Student*> enrolledStudents;
     vector<int> scheduleTimeSlots;
@@ -22,8 +157,8 @@ private:
 public:
     Course(int courseCode, string name, string requiredRoom, int maxCapacity) {
         this->courseCode = courseCode;
-        this->name = name;
-        this->requiredRoom = requiredRoom;
+        this->name = intern(name);
+        this->requiredRoom = intern(requiredRoom);
         this->maxCapacity = maxCapacity;
         this->assignedRoom = nullptr;
     }
@@ -37,18 +172,22 @@ public:
     }
 
     void setName(string name) {
-        this->name = name;
+        this->name = intern(name);
     }
 
-    string getName() const {
-        return name;
+    string_view getName() const {
+        return symbolText(name);
     }
 
     void setRequiredRoom(string requiredRoom) {
-        this->requiredRoom = requiredRoom;
+        this->requiredRoom = intern(requiredRoom);
+    }
+
+    string_view getRequiredRoom() const {
+        return symbolText(requiredRoom);
     }
 
-    string getRequiredRoom() const {
+    Symbol getRequiredRoomSymbol() const {
         return requiredRoom;
     }
 
@@ -95,13 +234,13 @@ public:
 class Student {
 private:
     int studentId;
-    string major;
+    Symbol major;
     vector<Course*> enrolledCourses;
     int academicYear;
 public:
     Student(int studentId, string major, int academicYear) {
         this->studentId = studentId;
-        this->major = major;
+        this->major = intern(major);
         this->academicYear = academicYear;
     }
 
@@ -114,10 +253,14 @@ public:
     }
 
     void setMajor(string major) {
-        this->major = major;
+        this->major = intern(major);
+    }
+
+    string_view getMajor() const {
+        return symbolText(major);
     }
 
-    string getMajor() const {
+    Symbol getMajorSymbol() const {
         return major;
     }
 
@@ -141,16 +284,16 @@ public:
 class Room {
 private:
     int roomNumber;
-    string type;
+    Symbol type;
     int capacity;
-    string specialEquipment;
+    Symbol specialEquipment;
     vector<int> availableTimeSlots;
 public:
     Room(int roomNumber, string type, int capacity, string specialEquipment) {
         this->roomNumber = roomNumber;
-        this->type = type;
+        this->type = intern(type);
         this->capacity = capacity;
-        this->specialEquipment = specialEquipment;
+        this->specialEquipment = intern(specialEquipment);
     }
 
     void setRoomNumber(int roomNumber) {
@@ -162,10 +305,14 @@ public:
     }
 
     void setType(string type) {
-        this->type = type;
+        this->type = intern(type);
+    }
+
+    string_view getType() const {
+        return symbolText(type);
     }
 
-    string getType() const {
+    Symbol getTypeSymbol() const {
         return type;
     }
 
@@ -178,10 +325,14 @@ public:
     }
 
     void setSpecialEquipment(string specialEquipment) {
-        this->specialEquipment = specialEquipment;
+        this->specialEquipment = intern(specialEquipment);
+    }
+
+    string_view getSpecialEquipment() const {
+        return symbolText(specialEquipment);
     }
 
-    string getSpecialEquipment() const {
+    Symbol getSpecialEquipmentSymbol() const {
         return specialEquipment;
     }
 
@@ -198,6 +349,7 @@ struct RegistrationRequest {
     Course* course;
     bool isCoreCourse;
     time_t timestamp;
+    uint64_t sequence; // Arrival order, breaks ties within the same second
 
     bool operator<(const RegistrationRequest& other) const {
         // First check year
@@ -208,8 +360,12 @@ struct RegistrationRequest {
         if (isCoreCourse != other.isCoreCourse) {
             return !isCoreCourse;
         }
-        // Finally check timestamp
-        return timestamp > other.timestamp;
+        // Then check timestamp
+        if (timestamp != other.timestamp) {
+            return timestamp > other.timestamp;
+        }
+        // Finally fall back to arrival order so equal requests never tie
+        return sequence > other.sequence;
     }
 };
 
@@ -223,7 +379,7 @@ bool hasScheduleConflict(vector<int>& schedule, int newTimeslot) {
 }
 
 bool isRoomSuitable(Room* room, Course* course) {
-    return (room->getType() == course->getRequiredRoom() &&
+    return (room->getTypeSymbol() == course->getRequiredRoomSymbol() &&
         room->getCapacity() >= course->getMaxCapacity());
 }
 
@@ -291,6 +447,367 @@ struct ScheduleEntry {
     TimeSlot timeSlot;
 };
 
+// Hierarchical timing wheel: 4 levels of 64 slots. Entries sit in the coarsest
+// level that covers their delay and cascade down as the wheel turns, so each
+// entry is touched at most once per level and nothing is ever scanned.
+class TimingWheel {
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    struct Timer {
+        uint64_t id;
+        uint64_t expiryTick;
+    };
+
+    uint64_t currentTick;
+    vector<Timer> slots[LEVELS][SLOTS];
+
+    void place(const Timer& timer) {
+        uint64_t delta = timer.expiryTick - currentTick;
+        uint64_t placement = timer.expiryTick;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+        // Beyond the top level's span: park in the furthest slot and re-place on cascade
+        if (level == LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * LEVELS))) {
+            placement = currentTick + (1ULL << (SLOT_BITS * LEVELS)) - 1;
+        }
+        slots[level][(placement >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(timer);
+    }
+
+public:
+    TimingWheel(uint64_t startTick = 0) {
+        this->currentTick = startTick;
+    }
+
+    uint64_t getCurrentTick() const {
+        return currentTick;
+    }
+
+    // Expiry ticks that have already passed fire on the next advance
+    void schedule(uint64_t id, uint64_t expiryTick) {
+        if (expiryTick <= currentTick) {
+            expiryTick = currentTick + 1;
+        }
+        place({ id, expiryTick });
+    }
+
+    // Turn the wheel up to nowTick, appending the ids of every timer that fired
+    void advance(uint64_t nowTick, vector<uint64_t>& expired) {
+        while (currentTick < nowTick) {
+            currentTick++;
+
+            // Find the highest level whose lower levels just wrapped, then cascade downwards
+            int top = 0;
+            while (top < LEVELS - 1 && (currentTick & ((1ULL << (SLOT_BITS * (top + 1))) - 1)) == 0) {
+                top++;
+            }
+            for (int level = top; level >= 1; level--) {
+                vector<Timer> bucket;
+                bucket.swap(slots[level][(currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+                for (const Timer& timer : bucket) {
+                    place(timer);
+                }
+            }
+
+            vector<Timer>& due = slots[0][currentTick & (SLOTS - 1)];
+            for (const Timer& timer : due) {
+                expired.push_back(timer.id);
+            }
+            due.clear();
+        }
+    }
+};
+
+// A provisional enrollment that is released unless confirmed before it expires
+struct SeatHold {
+    Student* student;
+    Course* course;
+};
+
+// How many members of a club are free in one time slot
+struct ClubSlot {
+    TimeSlot timeSlot;
+    int freeMembers;
+};
+
+// A proposed club meeting, room is nullptr if no room was left for any slot
+struct ClubMeeting {
+    Symbol club;
+    Room* room;
+    TimeSlot timeSlot;
+    int freeMembers;
+    int members;
+};
+
+// The 40 weekly slots fit one bit each in a 64-bit occupancy mask
+const int SLOTS_PER_DAY = 8;
+const int SLOTS_PER_WEEK = 5 * SLOTS_PER_DAY;
+const uint64_t ALL_SLOTS_MASK = (1ULL << SLOTS_PER_WEEK) - 1;
+
+int slotBit(TimeSlot slot) {
+    return (slot.day - 1) * SLOTS_PER_DAY + (slot.period - 1);
+}
+
+TimeSlot slotFromBit(int bit) {
+    return { bit / SLOTS_PER_DAY + 1, bit % SLOTS_PER_DAY + 1 };
+}
+
+// Rank every slot by how many of the given free-slot masks have it set. The masks
+// are summed with a bit-sliced adder: plane j holds bit j of every slot's count,
+// so each member costs a few word operations instead of a pass over 40 slots.
+vector<ClubSlot> rankFreeSlots(const vector<uint64_t>& freeMasks) {
+    vector<uint64_t> planes;
+    for (uint64_t mask : freeMasks) {
+        uint64_t carry = mask;
+        for (size_t j = 0; carry != 0; j++) {
+            if (j == planes.size()) planes.push_back(0);
+            uint64_t overflow = planes[j] & carry;
+            planes[j] ^= carry;
+            carry = overflow;
+        }
+    }
+
+    vector<ClubSlot> ranked;
+    for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+        int count = 0;
+        for (size_t j = 0; j < planes.size(); j++) {
+            count |= static_cast<int>((planes[j] >> bit) & 1) << j;
+        }
+        ranked.push_back({ slotFromBit(bit), count });
+    }
+
+    // Most members free first, earlier in the week on ties
+    stable_sort(ranked.begin(), ranked.end(),
+        [](const ClubSlot& a, const ClubSlot& b) { return a.freeMembers > b.freeMembers; });
+    return ranked;
+}
+
+// Room, slot and course-type counters kept up to date on every placement,
+// enrollment and release, so reports read them in O(1) instead of walking
+// roomSchedule and courseEnrollments.
+class ScheduleAnalytics {
+public:
+    struct RoomUsage {
+        int bookedSlots;
+        int enrolledSeats;
+        int wastedSeats; // Capacity left over by the courses placed here
+    };
+
+    struct SlotUsage {
+        int roomsBooked;
+        int enrolledSeats;
+    };
+
+    struct TypeDemand {
+        long long requests;
+        long long unmet;
+        int enrolledSeats;
+    };
+
+private:
+    const vector<Room*>& rooms;
+    unordered_map<Room*, size_t> roomIndex;
+    vector<RoomUsage> roomUsage;
+    SlotUsage slotUsage[SLOTS_PER_WEEK];
+    unordered_map<Symbol, TypeDemand> typeDemand;
+    long long wastedSeats;
+    long long enrolledSeats;
+    int bookedSlots;
+
+public:
+    ScheduleAnalytics(const vector<Room*>& rooms) : rooms(rooms) {
+        for (size_t i = 0; i < rooms.size(); i++) {
+            roomIndex[rooms[i]] = i;
+        }
+        roomUsage.assign(rooms.size(), { 0, 0, 0 });
+        for (SlotUsage& usage : slotUsage) {
+            usage = { 0, 0 };
+        }
+        this->wastedSeats = 0;
+        this->enrolledSeats = 0;
+        this->bookedSlots = 0;
+    }
+
+    void recordRequest(Course* course) {
+        typeDemand[course->getRequiredRoomSymbol()].requests++;
+    }
+
+    void recordUnmet(Course* course) {
+        typeDemand[course->getRequiredRoomSymbol()].unmet++;
+    }
+
+    // A course took a room for a slot
+    void recordPlacement(Course* course, Room* room, TimeSlot slot) {
+        int waste = room->getCapacity() - course->getMaxCapacity();
+        RoomUsage& usage = roomUsage[roomIndex[room]];
+        usage.bookedSlots++;
+        usage.wastedSeats += waste;
+        slotUsage[slotBit(slot)].roomsBooked++;
+        wastedSeats += waste;
+        bookedSlots++;
+    }
+
+    // The last student left, so the course gave its room slot back
+    void recordRemoval(Course* course, Room* room, TimeSlot slot) {
+        int waste = room->getCapacity() - course->getMaxCapacity();
+        RoomUsage& usage = roomUsage[roomIndex[room]];
+        usage.bookedSlots--;
+        usage.wastedSeats -= waste;
+        slotUsage[slotBit(slot)].roomsBooked--;
+        wastedSeats -= waste;
+        bookedSlots--;
+    }
+
+    // delta is +1 for an enrollment, -1 for a release
+    void recordEnrollment(const ScheduleEntry& entry, int delta) {
+        roomUsage[roomIndex[entry.room]].enrolledSeats += delta;
+        slotUsage[slotBit(entry.timeSlot)].enrolledSeats += delta;
+        typeDemand[entry.course->getRequiredRoomSymbol()].enrolledSeats += delta;
+        enrolledSeats += delta;
+    }
+
+    const RoomUsage& getRoomUsage(Room* room) const {
+        return roomUsage[roomIndex.at(room)];
+    }
+
+    const SlotUsage& getSlotUsage(TimeSlot slot) const {
+        return slotUsage[slotBit(slot)];
+    }
+
+    TypeDemand getTypeDemand(Symbol roomType) const {
+        auto it = typeDemand.find(roomType);
+        return it == typeDemand.end() ? TypeDemand{ 0, 0, 0 } : it->second;
+    }
+
+    double getRoomUtilization(Room* room) const {
+        return static_cast<double>(getRoomUsage(room).bookedSlots) / SLOTS_PER_WEEK;
+    }
+
+    double getSlotUtilization(TimeSlot slot) const {
+        return rooms.empty() ? 0 : static_cast<double>(getSlotUsage(slot).roomsBooked) / rooms.size();
+    }
+
+    long long getWastedSeats() const {
+        return wastedSeats;
+    }
+
+    long long getEnrolledSeats() const {
+        return enrolledSeats;
+    }
+
+    int getBookedSlots() const {
+        return bookedSlots;
+    }
+
+    bool exportCsv(const string& path) const {
+        ofstream out(path, ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        out << "room,type,capacity,booked_slots,utilization,enrolled_seats,wasted_seats\n";
+        for (size_t i = 0; i < rooms.size(); i++) {
+            const RoomUsage& usage = roomUsage[i];
+            out << rooms[i]->getRoomNumber() << "," << rooms[i]->getType() << ","
+                << rooms[i]->getCapacity() << "," << usage.bookedSlots << ","
+                << static_cast<double>(usage.bookedSlots) / SLOTS_PER_WEEK << ","
+                << usage.enrolledSeats << "," << usage.wastedSeats << "\n";
+        }
+
+        out << "\nday,period,rooms_booked,utilization,enrolled_seats\n";
+        for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+            TimeSlot slot = slotFromBit(bit);
+            out << slot.day << "," << slot.period << "," << slotUsage[bit].roomsBooked << ","
+                << getSlotUtilization(slot) << "," << slotUsage[bit].enrolledSeats << "\n";
+        }
+
+        out << "\nroom_type,requests,enrolled_seats,unmet\n";
+        for (const auto& demand : typeDemand) {
+            out << symbolText(demand.first) << "," << demand.second.requests << ","
+                << demand.second.enrolledSeats << "," << demand.second.unmet << "\n";
+        }
+
+        out << "\nbooked_slots,enrolled_seats,wasted_seats\n"
+            << bookedSlots << "," << enrolledSeats << "," << wastedSeats << "\n";
+        out.close();
+        return static_cast<bool>(out);
+    }
+};
+
+enum TimetableFormat {
+    TIMETABLE_TEXT,
+    TIMETABLE_CSV,
+    TIMETABLE_JSON
+};
+
+// Copies bytes to out + size, or only counts them when out is null. Sizing and
+// rendering share the same code so the pre-sized buffer is always exact.
+struct RenderCursor {
+    char* out;
+    size_t size;
+
+    void put(const char* data, size_t length) {
+        if (out != nullptr) memcpy(out + size, data, length);
+        size += length;
+    }
+
+    void put(string_view text) {
+        put(text.data(), text.size());
+    }
+
+    void putInt(long long value) {
+        char digits[24];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), value);
+        put(digits, result.ptr - digits);
+    }
+};
+
+string jsonEscape(string_view text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// The part of a timetable line that is the same for every student in the course
+string renderTimetableBlock(const ScheduleEntry& entry, size_t enrolled, TimetableFormat format) {
+    string block;
+    string room = to_string(entry.room->getRoomNumber());
+    string count = to_string(enrolled);
+    string capacity = to_string(entry.course->getMaxCapacity());
+    string code = to_string(entry.course->getCourseCode());
+
+    switch (format) {
+    case TIMETABLE_TEXT:
+        block.append(entry.course->getName()).append("\n  Room: ").append(room)
+            .append("\n  Time: ").append(entry.timeSlot.toString())
+            .append("\n  Current Enrollment: ").append(count).append("/").append(capacity).append("\n\n");
+        break;
+    case TIMETABLE_CSV:
+        block.append(",").append(code).append(",\"").append(entry.course->getName()).append("\",")
+            .append(room).append(",").append(to_string(entry.timeSlot.day)).append(",")
+            .append(to_string(entry.timeSlot.period)).append(",").append(count).append(",")
+            .append(capacity).append("\n");
+        break;
+    case TIMETABLE_JSON:
+        block.append("{\"code\":").append(code)
+            .append(",\"name\":\"").append(jsonEscape(entry.course->getName()))
+            .append("\",\"room\":").append(room)
+            .append(",\"day\":").append(to_string(entry.timeSlot.day))
+            .append(",\"period\":").append(to_string(entry.timeSlot.period))
+            .append(",\"enrolled\":").append(count)
+            .append(",\"capacity\":").append(capacity).append("}");
+        break;
+    }
+    return block;
+}
+
 class ScheduleOptimizer {
 private:
     vector<Room*>& rooms;
@@ -298,6 +815,10 @@ private:
     map<Room*, vector<TimeSlot>> roomSchedule;
     map<Student*, vector<ScheduleEntry>> studentSchedules;
     map<Course*, vector<Student*>> courseEnrollments;
+    unordered_map<uint64_t, SeatHold> seatHolds;
+    TimingWheel holdExpiry;
+    uint64_t nextHoldId;
+    ScheduleAnalytics analytics;
 
     // Initialize available time slots (Monday-Friday, 8 periods each)
     void initializeTimeSlots() {
@@ -334,13 +855,114 @@ private:
         return true;
     }
 
+    // One student's timetable in the given format, see RenderCursor
+    void renderStudentTimetable(RenderCursor& cursor, Student* student, const vector<ScheduleEntry>& entries,
+        const unordered_map<Course*, string>& blocks, TimetableFormat format, bool first) {
+        switch (format) {
+        case TIMETABLE_TEXT:
+            cursor.put("\nSchedule for Student ID ");
+            cursor.putInt(student->getStudentId());
+            cursor.put(":\n");
+            for (const ScheduleEntry& entry : entries) {
+                cursor.put(blocks.at(entry.course));
+            }
+            break;
+        case TIMETABLE_CSV:
+            for (const ScheduleEntry& entry : entries) {
+                cursor.putInt(student->getStudentId());
+                cursor.put(",");
+                cursor.putInt(student->getAcademicYear());
+                cursor.put(blocks.at(entry.course));
+            }
+            break;
+        case TIMETABLE_JSON:
+            cursor.put(first ? "{\"student_id\":" : ",\n{\"student_id\":");
+            cursor.putInt(student->getStudentId());
+            cursor.put(",\"academic_year\":");
+            cursor.putInt(student->getAcademicYear());
+            cursor.put(",\"courses\":[");
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (i > 0) cursor.put(",");
+                cursor.put(blocks.at(entries[i].course));
+            }
+            cursor.put("]}");
+            break;
+        }
+    }
+
+    bool writeTimetableFile(const string& path, const vector<pair<Student*, const vector<ScheduleEntry>*>>& students,
+        size_t begin, size_t end, const unordered_map<Course*, string>& blocks, TimetableFormat format,
+        int threadCount, bool writeIndex) {
+        string header = format == TIMETABLE_CSV
+            ? "student_id,academic_year,course_code,course_name,room,day,period,enrolled,capacity\n"
+            : (format == TIMETABLE_JSON ? "[\n" : "");
+        string footer = format == TIMETABLE_JSON ? "\n]\n" : "";
+        size_t count = end - begin;
+        if (threadCount < 1) threadCount = 1;
+
+        // Runs work(i) for every student index, split across the worker threads
+        auto parallel = [count, threadCount](const function<void(size_t)>& work) {
+            vector<thread> workers;
+            size_t chunk = (count + threadCount - 1) / threadCount;
+            for (size_t from = 0; from < count; from += chunk) {
+                size_t to = min(count, from + chunk);
+                workers.push_back(thread([&work, from, to]() {
+                    for (size_t i = from; i < to; i++) work(i);
+                }));
+            }
+            for (thread& worker : workers) {
+                worker.join();
+            }
+        };
+
+        vector<size_t> offsets(count + 1, 0);
+        parallel([&](size_t i) {
+            RenderCursor sizing = { nullptr, 0 };
+            renderStudentTimetable(sizing, students[begin + i].first, *students[begin + i].second, blocks, format, i == 0);
+            offsets[i + 1] = sizing.size;
+        });
+        offsets[0] = header.size();
+        for (size_t i = 0; i < count; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        string buffer(offsets[count] + footer.size(), '\0');
+        memcpy(&buffer[0], header.data(), header.size());
+        memcpy(&buffer[offsets[count]], footer.data(), footer.size());
+        parallel([&](size_t i) {
+            RenderCursor cursor = { &buffer[offsets[i]], 0 };
+            renderStudentTimetable(cursor, students[begin + i].first, *students[begin + i].second, blocks, format, i == 0);
+        });
+
+        ofstream out(path, ios::binary | ios::trunc);
+        out.write(buffer.data(), buffer.size());
+        out.close();
+        if (!out) {
+            return false;
+        }
+
+        if (writeIndex) {
+            string index = "student_id,offset,length\n";
+            for (size_t i = 0; i < count; i++) {
+                index.append(to_string(students[begin + i].first->getStudentId())).append(",")
+                    .append(to_string(offsets[i])).append(",")
+                    .append(to_string(offsets[i + 1] - offsets[i])).append("\n");
+            }
+            ofstream indexOut(path + ".idx", ios::binary | ios::trunc);
+            indexOut.write(index.data(), index.size());
+            indexOut.close();
+            return static_cast<bool>(indexOut);
+        }
+        return true;
+    }
+
     // Find best room based on capacity and equipment needs
     Room* findOptimalRoom(Course* course, TimeSlot slot) {
         Room* bestRoom = nullptr;
         int minWastedSpace = INT_MAX;
 
         for (Room* room : rooms) {
-            if (room->getType() == course->getRequiredRoom() &&
+            if (room->getTypeSymbol() == course->getRequiredRoomSymbol() &&
                 room->getCapacity() >= course->getMaxCapacity() &&
                 isRoomAvailable(room, slot)) {
 
@@ -379,13 +1001,15 @@ private:
     }
 
 public:
-    ScheduleOptimizer(vector<Room*>& rooms) : rooms(rooms) {
+    ScheduleOptimizer(vector<Room*>& rooms) : rooms(rooms), analytics(rooms) {
+        this->nextHoldId = 1;
         initializeTimeSlots();
     }
 
     bool scheduleRegistration(RegistrationRequest& request) {
         Course* course = request.course;
         Student* student = request.student;
+        analytics.recordRequest(course);
 
         // Add student to course enrollments
         if (courseEnrollments.find(course) == courseEnrollments.end()) {
@@ -394,6 +1018,7 @@ public:
 
         // Check if course is already at capacity
         if (courseEnrollments[course].size() >= course->getMaxCapacity()) {
+            analytics.recordUnmet(course);
             return false;
         }
 
@@ -419,43 +1044,2488 @@ public:
                 }
                 roomSchedule[optimalRoom].push_back(optimalSlot);
 
+                analytics.recordPlacement(course, optimalRoom, optimalSlot);
+                analytics.recordEnrollment(entry, 1);
                 return true;
             }
         }
         else {
             // Course already scheduled, check if student can join
-            ScheduleEntry existingEntry = studentSchedules[courseEnrollments[course][0]][0];
+            ScheduleEntry existingEntry = *findScheduleEntry(courseEnrollments[course][0], course);
             if (!hasScheduleConflict(student, existingEntry.timeSlot)) {
                 studentSchedules[student].push_back(existingEntry);
                 courseEnrollments[course].push_back(student);
+                analytics.recordEnrollment(existingEntry, 1);
                 return true;
             }
         }
 
+        analytics.recordUnmet(course);
         return false;
     }
 
-    void printStudentSchedule(Student* student) {
-        cout << "\nSchedule for Student ID " << student->getStudentId() << ":\n";
-        if (studentSchedules.find(student) != studentSchedules.end()) {
-            for (const ScheduleEntry& entry : studentSchedules[student]) {
-                cout << entry.course->getName() << "\n"
-                    << "  Room: " << entry.room->getRoomNumber() << "\n"
-                    << "  Time: " << entry.timeSlot.toString() << "\n"
-                    << "  Current Enrollment: " << courseEnrollments[entry.course].size()
-                    << "/" << entry.course->getMaxCapacity() << "\n\n";
+    // Undo an enrollment. The seat goes straight back to the course, and the room
+    // slot is freed once the course has nobody left in it.
+    bool releaseRegistration(Student* student, Course* course) {
+        auto schedule = studentSchedules.find(student);
+        auto enrollment = courseEnrollments.find(course);
+        if (schedule == studentSchedules.end() || enrollment == courseEnrollments.end()) {
+            return false;
+        }
+
+        vector<ScheduleEntry>& entries = schedule->second;
+        auto entry = find_if(entries.begin(), entries.end(),
+            [course](const ScheduleEntry& e) { return e.course == course; });
+        if (entry == entries.end()) {
+            return false;
+        }
+        ScheduleEntry released = *entry;
+        entries.erase(entry);
+
+        vector<Student*>& students = enrollment->second;
+        students.erase(find(students.begin(), students.end(), student));
+        analytics.recordEnrollment(released, -1);
+
+        if (students.empty()) {
+            vector<TimeSlot>& slots = roomSchedule[released.room];
+            auto slot = find(slots.begin(), slots.end(), released.timeSlot);
+            if (slot != slots.end()) {
+                slots.erase(slot);
+                analytics.recordRemoval(course, released.room, released.timeSlot);
             }
         }
+        return true;
     }
-};
 
-int main() {
-    // Create rooms
-    vector<Room*> rooms;
-    rooms.push_back(new Room(201, "Classroom", 40, "Whiteboard"));
-    rooms.push_back(new Room(202, "Lab", 30, "Computers"));
-    rooms.push_back(new Room(203, "Classroom", 35, "Whiteboard"));
-    rooms.push_back(new Room(204, "Lab", 25, "Computers"));
+    // Schedule the request as a hold that lapses at nowTick + ttlTicks unless
+    // confirmed. Returns the hold id, or 0 if the request could not be placed.
+    uint64_t holdRegistration(RegistrationRequest& request, uint64_t nowTick, uint64_t ttlTicks) {
+        expireHolds(nowTick);
+        if (!scheduleRegistration(request)) {
+            return 0;
+        }
+
+        uint64_t holdId = nextHoldId++;
+        seatHolds[holdId] = { request.student, request.course };
+        holdExpiry.schedule(holdId, nowTick + ttlTicks);
+        return holdId;
+    }
+
+    // Make a hold permanent, false if it already expired
+    bool confirmHold(uint64_t holdId) {
+        // The wheel keeps the id until its tick comes round; expireHolds skips it then
+        return seatHolds.erase(holdId) > 0;
+    }
+
+    // Release every hold whose TTL has run out by nowTick, returns how many
+    int expireHolds(uint64_t nowTick) {
+        vector<uint64_t> expired;
+        holdExpiry.advance(nowTick, expired);
+
+        int released = 0;
+        for (uint64_t holdId : expired) {
+            auto hold = seatHolds.find(holdId);
+            if (hold == seatHolds.end()) continue; // Confirmed in time
+
+            releaseRegistration(hold->second.student, hold->second.course);
+            seatHolds.erase(hold);
+            released++;
+        }
+        return released;
+    }
+
+    // Take a room slot out of use without a course in it, e.g. one another shard owns
+    void blockRoomSlot(Room* room, TimeSlot slot) {
+        roomSchedule[room].push_back(slot);
+    }
+
+    void unblockRoomSlot(Room* room, TimeSlot slot) {
+        vector<TimeSlot>& slots = roomSchedule[room];
+        auto occupied = find(slots.begin(), slots.end(), slot);
+        if (occupied != slots.end()) {
+            slots.erase(occupied);
+        }
+    }
+
+    // One entry per course that currently holds a room slot
+    vector<ScheduleEntry> getCoursePlacements() {
+        vector<ScheduleEntry> placements;
+        for (const auto& enrollment : courseEnrollments) {
+            if (!enrollment.second.empty()) {
+                placements.push_back(*findScheduleEntry(enrollment.second[0], enrollment.first));
+            }
+        }
+        return placements;
+    }
+
+    // Every student's enrolled entries, one pair per class
+    vector<pair<Student*, ScheduleEntry>> getEnrollments() {
+        vector<pair<Student*, ScheduleEntry>> enrollments;
+        for (const auto& schedule : studentSchedules) {
+            for (const ScheduleEntry& entry : schedule.second) {
+                enrollments.push_back({ schedule.first, entry });
+            }
+        }
+        return enrollments;
+    }
+
+    int getEnrollmentCount(Course* course) const {
+        auto enrollment = courseEnrollments.find(course);
+        return enrollment == courseEnrollments.end() ? 0 : static_cast<int>(enrollment->second.size());
+    }
+
+    const ScheduleAnalytics& getAnalytics() const {
+        return analytics;
+    }
+
+    size_t getPendingHolds() const {
+        return seatHolds.size();
+    }
+
+    // Bit per weekly slot the student has a class in
+    uint64_t getOccupancyMask(Student* student) {
+        uint64_t mask = 0;
+        auto schedule = studentSchedules.find(student);
+        if (schedule != studentSchedules.end()) {
+            for (const ScheduleEntry& entry : schedule->second) {
+                mask |= 1ULL << slotBit(entry.timeSlot);
+            }
+        }
+        return mask;
+    }
+
+    // Slots ranked by how many of the roster have no class then
+    vector<ClubSlot> findCommonFreeTime(const vector<Student*>& roster) {
+        vector<uint64_t> freeMasks;
+        for (Student* student : roster) {
+            freeMasks.push_back(~getOccupancyMask(student) & ALL_SLOTS_MASK);
+        }
+        return rankFreeSlots(freeMasks);
+    }
+
+    // Propose a meeting slot and room for every club. Rankings are computed in
+    // parallel from a snapshot of member timetables; rooms are then handed out
+    // largest club first so no room is double-booked against classes or another club.
+    // Members of a club that has been given a slot count as busy then, and later
+    // clubs sharing those members are re-ranked so their free counts stay true.
+    vector<ClubMeeting> proposeClubMeetings(const map<Symbol, vector<Student*>>& clubs, int threadCount) {
+        vector<Symbol> names;
+        vector<vector<uint64_t>> freeMasks;
+        for (const auto& club : clubs) {
+            names.push_back(club.first);
+            vector<uint64_t> masks;
+            for (Student* student : club.second) {
+                masks.push_back(~getOccupancyMask(student) & ALL_SLOTS_MASK);
+            }
+            freeMasks.push_back(masks);
+        }
+
+        vector<const vector<Student*>*> rosters;
+        for (const auto& club : clubs) {
+            rosters.push_back(&club.second);
+        }
+
+        vector<vector<ClubSlot>> rankings(names.size());
+        vector<thread> workers;
+        if (threadCount < 1) threadCount = 1;
+        for (int t = 0; t < threadCount; t++) {
+            workers.push_back(thread([&rankings, &freeMasks, t, threadCount]() {
+                for (size_t i = t; i < rankings.size(); i += threadCount) {
+                    rankings[i] = rankFreeSlots(freeMasks[i]);
+                }
+            }));
+        }
+        for (thread& worker : workers) {
+            worker.join();
+        }
+
+        map<Room*, uint64_t> roomBusy;
+        for (Room* room : rooms) {
+            uint64_t mask = 0;
+            if (roomSchedule.find(room) != roomSchedule.end()) {
+                for (const TimeSlot& occupied : roomSchedule[room]) {
+                    mask |= 1ULL << slotBit(occupied);
+                }
+            }
+            roomBusy[room] = mask;
+        }
+
+        vector<size_t> order;
+        for (size_t i = 0; i < names.size(); i++) {
+            order.push_back(i);
+        }
+        stable_sort(order.begin(), order.end(),
+            [&freeMasks](size_t a, size_t b) { return freeMasks[a].size() > freeMasks[b].size(); });
+
+        map<Student*, uint64_t> meetingBusy;
+        vector<ClubMeeting> meetings;
+        for (size_t i : order) {
+            int members = static_cast<int>(freeMasks[i].size());
+
+            bool shared = false;
+            for (size_t m = 0; m < rosters[i]->size(); m++) {
+                auto busy = meetingBusy.find((*rosters[i])[m]);
+                if (busy != meetingBusy.end()) {
+                    freeMasks[i][m] &= ~busy->second;
+                    shared = true;
+                }
+            }
+            if (shared) {
+                rankings[i] = rankFreeSlots(freeMasks[i]);
+            }
+
+            ClubMeeting meeting = { names[i], nullptr, rankings[i][0].timeSlot, rankings[i][0].freeMembers, members };
+
+            for (const ClubSlot& candidate : rankings[i]) {
+                uint64_t bit = 1ULL << slotBit(candidate.timeSlot);
+                Room* bestRoom = nullptr;
+                int minWastedSpace = INT_MAX;
+                for (Room* room : rooms) {
+                    if (room->getCapacity() >= members && !(roomBusy[room] & bit) &&
+                        room->getCapacity() - members < minWastedSpace) {
+                        minWastedSpace = room->getCapacity() - members;
+                        bestRoom = room;
+                    }
+                }
+                if (bestRoom != nullptr) {
+                    roomBusy[bestRoom] |= bit;
+                    meeting.room = bestRoom;
+                    meeting.timeSlot = candidate.timeSlot;
+                    meeting.freeMembers = candidate.freeMembers;
+                    for (size_t m = 0; m < rosters[i]->size(); m++) {
+                        if (freeMasks[i][m] & bit) {
+                            meetingBusy[(*rosters[i])[m]] |= bit;
+                        }
+                    }
+                    break;
+                }
+            }
+            meetings.push_back(meeting);
+        }
+        return meetings;
+    }
+
+    // FNV-1a over every student's timetable in student id order, so two runs can be
+    // compared without keeping their full schedules around
+    uint64_t scheduleDigest() {
+        vector<tuple<int, int, int, int, int>> rows;
+        for (const auto& schedule : studentSchedules) {
+            for (const ScheduleEntry& entry : schedule.second) {
+                rows.push_back(make_tuple(schedule.first->getStudentId(), entry.course->getCourseCode(),
+                    entry.room->getRoomNumber(), entry.timeSlot.day, entry.timeSlot.period));
+            }
+        }
+        sort(rows.begin(), rows.end());
+
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](int value) {
+            for (int i = 0; i < 4; i++) {
+                hash ^= static_cast<uint8_t>(value >> (8 * i));
+                hash *= 1099511628211ULL;
+            }
+        };
+        for (const auto& row : rows) {
+            mix(get<0>(row));
+            mix(get<1>(row));
+            mix(get<2>(row));
+            mix(get<3>(row));
+            mix(get<4>(row));
+        }
+        return hash;
+    }
+
+    // Find the entry placing a student in a course, or nullptr if not enrolled
+    const ScheduleEntry* findScheduleEntry(Student* student, Course* course) {
+        auto it = studentSchedules.find(student);
+        if (it == studentSchedules.end()) {
+            return nullptr;
+        }
+
+        for (const ScheduleEntry& entry : it->second) {
+            if (entry.course == course) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // Render every student's timetable and write it out. With perCohort there is one
+    // file per academic year, otherwise one file plus a "<file>.idx" of student byte
+    // ranges. Each file is sized exactly first, then rendered in parallel straight
+    // into one buffer from per-course blocks prepared once, so nothing is allocated
+    // per line.
+    bool exportTimetables(const string& basePath, TimetableFormat format, bool perCohort, int threadCount) {
+        unordered_map<Course*, string> blocks;
+        for (const auto& enrollment : courseEnrollments) {
+            if (enrollment.second.empty()) continue;
+            const ScheduleEntry* entry = findScheduleEntry(enrollment.second[0], enrollment.first);
+            blocks[enrollment.first] = renderTimetableBlock(*entry, enrollment.second.size(), format);
+        }
+
+        vector<pair<Student*, const vector<ScheduleEntry>*>> students;
+        for (const auto& schedule : studentSchedules) {
+            if (!schedule.second.empty()) {
+                students.push_back({ schedule.first, &schedule.second });
+            }
+        }
+        sort(students.begin(), students.end(),
+            [](const pair<Student*, const vector<ScheduleEntry>*>& a, const pair<Student*, const vector<ScheduleEntry>*>& b) {
+                if (a.first->getAcademicYear() != b.first->getAcademicYear()) {
+                    return a.first->getAcademicYear() < b.first->getAcademicYear();
+                }
+                return a.first->getStudentId() < b.first->getStudentId();
+            });
+
+        string extension = format == TIMETABLE_CSV ? ".csv" : (format == TIMETABLE_JSON ? ".json" : ".txt");
+        if (!perCohort) {
+            return writeTimetableFile(basePath + extension, students, 0, students.size(), blocks, format, threadCount, true);
+        }
+
+        size_t start = 0;
+        while (start < students.size()) {
+            int year = students[start].first->getAcademicYear();
+            size_t end = start;
+            while (end < students.size() && students[end].first->getAcademicYear() == year) end++;
+            string path = basePath + "_year" + to_string(year) + extension;
+            if (!writeTimetableFile(path, students, start, end, blocks, format, threadCount, false)) {
+                return false;
+            }
+            start = end;
+        }
+        return true;
+    }
+
+    void printStudentSchedule(Student* student) {
+        cout << "\nSchedule for Student ID " << student->getStudentId() << ":\n";
+        if (studentSchedules.find(student) != studentSchedules.end()) {
+            for (const ScheduleEntry& entry : studentSchedules[student]) {
+                cout << entry.course->getName() << "\n"
+                    << "  Room: " << entry.room->getRoomNumber() << "\n"
+                    << "  Time: " << entry.timeSlot.toString() << "\n"
+                    << "  Current Enrollment: " << courseEnrollments[entry.course].size()
+                    << "/" << entry.course->getMaxCapacity() << "\n\n";
+            }
+        }
+    }
+};
+
+// Rooms available on campus each term
+vector<Room*> createCampusRooms() {
+    vector<Room*> rooms;
+    rooms.push_back(new Room(201, "Classroom", 40, "Whiteboard"));
+    rooms.push_back(new Room(202, "Lab", 30, "Computers"));
+    rooms.push_back(new Room(203, "Classroom", 35, "Whiteboard"));
+    rooms.push_back(new Room(204, "Lab", 25, "Computers"));
+    return rooms;
+}
+
+// Reads the MEMBERSHIPS section of the club system state file into club -> member
+// name symbols. Lines are usually "member:club" but some are written "club:member"; a
+// club is a CLUBS entry that appears on the right of a line whose left is not one.
+map<Symbol, vector<Symbol>> loadClubMemberships(const string& path) {
+    ifstream file(path);
+    map<Symbol, vector<Symbol>> clubs;
+    if (!file) {
+        cout << "Could not open " << path << "\n";
+        return clubs;
+    }
+
+    set<Symbol> listed;
+    vector<pair<Symbol, Symbol>> links;
+    string line;
+    string section;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line == "STUDENTS:" || line == "CLUBS:" || line == "MEMBERSHIPS:") {
+            section = line;
+            continue;
+        }
+        if (line.rfind("END_", 0) == 0) {
+            section = "";
+            continue;
+        }
+        if (line.empty()) continue;
+
+        if (section == "CLUBS:") {
+            listed.insert(intern(line));
+        }
+        else if (section == "MEMBERSHIPS:") {
+            size_t colon = line.find(':');
+            if (colon != string::npos) {
+                string_view text(line);
+                links.push_back({ intern(text.substr(0, colon)), intern(text.substr(colon + 1)) });
+            }
+        }
+    }
+
+    set<Symbol> clubNames;
+    for (const auto& link : links) {
+        if (listed.count(link.second) && !listed.count(link.first)) {
+            clubNames.insert(link.second);
+        }
+    }
+
+    set<pair<Symbol, Symbol>> seen;
+    for (const auto& link : links) {
+        Symbol club = link.second;
+        Symbol member = link.first;
+        if (!clubNames.count(club)) {
+            swap(club, member);
+        }
+        if (clubNames.count(club) && !clubNames.count(member) && seen.insert({ club, member }).second) {
+            clubs[club].push_back(member);
+        }
+    }
+    return clubs;
+}
+
+// Entry point for "clubs [stateFile] [clubName]". Members are enrolled into their
+// year's courses first so the proposals are made against real timetables. With a
+// club name only that club's common free slots are listed, best first.
+int runClubMeetingPlanner(int argc, char* argv[]) {
+    string path = argc > 2 ? argv[2] : "club_system_state.txt";
+    map<Symbol, vector<Symbol>> memberships = loadClubMemberships(path);
+    if (memberships.empty()) {
+        cout << "No club memberships found\n";
+        return 1;
+    }
+
+    vector<Room*> rooms = createCampusRooms();
+    ScheduleOptimizer scheduler(rooms);
+    vector<Course*> courses;
+    for (int year = 1; year <= 3; year++) {
+        vector<Course*> yearCourses = getCoursesForYear(year);
+        courses.insert(courses.end(), yearCourses.begin(), yearCourses.end());
+    }
+
+    map<Symbol, Student*> students;
+    map<Symbol, vector<Student*>> clubs;
+    for (const auto& club : memberships) {
+        for (Symbol member : club.second) {
+            if (students.find(member) == students.end()) {
+                int id = static_cast<int>(students.size()) + 1;
+                Student* student = new Student(id, "Computer Science", (id % 3) + 1);
+                students[member] = student;
+
+                for (Course* course : courses) {
+                    if (course->getCourseCode() / 100 == student->getAcademicYear()) {
+                        RegistrationRequest req = { student, course, true, time(nullptr), 0 };
+                        scheduler.scheduleRegistration(req);
+                    }
+                }
+            }
+            clubs[club.first].push_back(students[member]);
+        }
+    }
+
+    int result = 0;
+    if (argc > 3) {
+        auto club = clubs.find(intern(argv[3]));
+        if (club == clubs.end()) {
+            cout << "No club named " << argv[3] << "\n";
+            result = 1;
+        }
+        else {
+            int members = static_cast<int>(club->second.size());
+            cout << argv[3] << " (" << members << " members), free slots:\n";
+            for (const ClubSlot& slot : scheduler.findCommonFreeTime(club->second)) {
+                if (slot.freeMembers == 0) break;
+                cout << "  " << slot.timeSlot.toString() << ": " << slot.freeMembers << "/" << members << " free\n";
+            }
+        }
+    }
+    else {
+        for (const ClubMeeting& meeting : scheduler.proposeClubMeetings(clubs, thread::hardware_concurrency())) {
+            cout << symbolText(meeting.club) << " (" << meeting.members << " members): ";
+            if (meeting.room == nullptr) {
+                cout << "no room available\n";
+            }
+            else {
+                cout << meeting.timeSlot.toString() << ", Room " << meeting.room->getRoomNumber()
+                    << ", " << meeting.freeMembers << "/" << meeting.members << " free\n";
+            }
+        }
+    }
+
+    for (auto& student : students) {
+        delete student.second;
+    }
+    for (Course* course : courses) {
+        delete course;
+    }
+    for (Room* room : rooms) {
+        delete room;
+    }
+    return result;
+}
+
+// One protocol line read from a session:
+//   REGISTER <studentId> <year> <courseCode> <core>
+//   HOLD <studentId> <year> <courseCode> <core> <ttlSeconds>
+//   CONFIRM <holdId>
+struct ParsedRegistration {
+    int loopIndex;
+    uint64_t connectionId;
+    uint64_t arrivalNanos; // Monotonic, since the server started
+    uint64_t sequence;     // Order the scheduler received it in
+    string command;
+    int studentId;
+    int academicYear;
+    int courseCode;
+    bool isCoreCourse;
+    int ttlSeconds;
+    uint64_t holdId;
+};
+
+// A registration waiting in the scheduler's priority queue, with the line it came from
+struct PendingRegistration {
+    RegistrationRequest request;
+    const ParsedRegistration* source;
+
+    bool operator<(const PendingRegistration& other) const {
+        return request < other.request;
+    }
+};
+
+// Parses one protocol line, returns false if it is malformed
+bool parseRegistrationLine(const string& line, ParsedRegistration& parsed) {
+    istringstream in(line);
+    int core = 0;
+    parsed.studentId = 0;
+    parsed.academicYear = 0;
+    parsed.courseCode = 0;
+    parsed.isCoreCourse = false;
+    parsed.ttlSeconds = 0;
+    parsed.holdId = 0;
+    if (!(in >> parsed.command)) {
+        return false;
+    }
+
+    if (parsed.command == "CONFIRM") {
+        return static_cast<bool>(in >> parsed.holdId);
+    }
+    if (!(in >> parsed.studentId >> parsed.academicYear >> parsed.courseCode >> core)) {
+        return false;
+    }
+    parsed.isCoreCourse = (core != 0);
+
+    // Values outside what a trace record can hold would replay as different requests
+    if (parsed.academicYear < 0 || parsed.academicYear > UINT8_MAX ||
+        parsed.courseCode < 0 || parsed.courseCode > UINT16_MAX) {
+        return false;
+    }
+
+    if (parsed.command == "HOLD") {
+        return (in >> parsed.ttlSeconds) && parsed.ttlSeconds > 0;
+    }
+    return parsed.command == "REGISTER";
+}
+
+// The years RegistrationProcessor accepts requests for
+bool isValidAcademicYear(int year) {
+    return year >= 1 && year <= 3;
+}
+
+// Every course on offer, keyed by course code
+map<int, Course*> createCourseCatalogue() {
+    map<int, Course*> catalogue;
+    for (int year = 1; year <= 3; year++) {
+        for (Course* course : getCoursesForYear(year)) {
+            catalogue[course->getCourseCode()] = course;
+        }
+    }
+    return catalogue;
+}
+
+// Turns batches of parsed requests into ScheduleOptimizer calls. Shared by the
+// live server and the trace replayer so both take exactly the same decisions.
+class RegistrationProcessor {
+private:
+    ScheduleOptimizer& scheduler;
+    map<int, Course*>& catalogue;
+    map<int, Student*> students;
+    long long enrolled;
+    long long rejected;
+    long long holdsExpired;
+
+    Student* findOrCreateStudent(int studentId, int academicYear) {
+        auto it = students.find(studentId);
+        if (it != students.end()) {
+            return it->second;
+        }
+        Student* student = new Student(studentId, "Computer Science", academicYear);
+        students[studentId] = student;
+        return student;
+    }
+
+public:
+    RegistrationProcessor(ScheduleOptimizer& scheduler, map<int, Course*>& catalogue)
+        : scheduler(scheduler), catalogue(catalogue) {
+        this->enrolled = 0;
+        this->rejected = 0;
+        this->holdsExpired = 0;
+    }
+
+    ~RegistrationProcessor() {
+        for (auto& student : students) {
+            delete student.second;
+        }
+    }
+
+    // One scheduler round: confirmations, then hold expiry at nowTick, then the
+    // new requests in RegistrationRequest priority order. respond gets one
+    // protocol line per request.
+    void processBatch(const vector<ParsedRegistration>& batch, uint64_t nowTick,
+        const function<void(const ParsedRegistration&, const string&)>& respond) {
+        // Confirmations are answered before expiry so one arriving in time is honoured
+        for (const ParsedRegistration& parsed : batch) {
+            if (parsed.command != "CONFIRM") continue;
+            string outcome = scheduler.confirmHold(parsed.holdId) ? "CONFIRMED " : "EXPIRED ";
+            respond(parsed, outcome + to_string(parsed.holdId) + "\n");
+        }
+        holdsExpired += scheduler.expireHolds(nowTick);
+
+        priority_queue<PendingRegistration> regQueue;
+        for (const ParsedRegistration& parsed : batch) {
+            if (parsed.command == "CONFIRM") continue;
+
+            if (!isValidAcademicYear(parsed.academicYear)) {
+                respond(parsed, "ERROR invalid year " + to_string(parsed.academicYear) + "\n");
+                continue;
+            }
+            auto course = catalogue.find(parsed.courseCode);
+            if (course == catalogue.end()) {
+                respond(parsed, "ERROR unknown course " + to_string(parsed.courseCode) + "\n");
+                continue;
+            }
+            // A student's year sets their priority, so it may not change between requests
+            auto known = students.find(parsed.studentId);
+            if (known != students.end() && known->second->getAcademicYear() != parsed.academicYear) {
+                respond(parsed, "ERROR student " + to_string(parsed.studentId) + " is in year "
+                    + to_string(known->second->getAcademicYear()) + "\n");
+                continue;
+            }
+
+            PendingRegistration pending;
+            pending.request.student = findOrCreateStudent(parsed.studentId, parsed.academicYear);
+            pending.request.course = course->second;
+            pending.request.isCoreCourse = parsed.isCoreCourse;
+            // Seconds since the server started rather than wall time, so a replay orders identically
+            pending.request.timestamp = static_cast<time_t>(parsed.arrivalNanos / 1000000000ULL);
+            pending.request.sequence = parsed.sequence;
+            pending.source = &parsed;
+            regQueue.push(pending);
+        }
+
+        while (!regQueue.empty()) {
+            PendingRegistration current = regQueue.top();
+            regQueue.pop();
+
+            string response;
+            uint64_t holdId = 0;
+            bool placed;
+            if (current.source->ttlSeconds > 0) {
+                holdId = scheduler.holdRegistration(current.request, nowTick, current.source->ttlSeconds * 1000ULL);
+                placed = holdId != 0;
+            }
+            else {
+                placed = scheduler.scheduleRegistration(current.request);
+            }
+
+            if (placed) {
+                const ScheduleEntry* entry =
+                    scheduler.findScheduleEntry(current.request.student, current.request.course);
+                response = (holdId != 0 ? "HELD " + to_string(holdId) + " " : string("ENROLLED "))
+                    + to_string(entry->course->getCourseCode()) + " "
+                    + to_string(entry->room->getRoomNumber()) + " "
+                    + to_string(entry->timeSlot.day) + " "
+                    + to_string(entry->timeSlot.period) + "\n";
+                enrolled++;
+            }
+            else {
+                response = "REJECTED " + to_string(current.request.course->getCourseCode()) + "\n";
+                rejected++;
+            }
+            respond(*current.source, response);
+        }
+    }
+
+    long long getEnrolled() const {
+        return enrolled;
+    }
+
+    long long getRejected() const {
+        return rejected;
+    }
+
+    long long getHoldsExpired() const {
+        return holdsExpired;
+    }
+};
+
+// Fixed-size trace record, written in host byte order. A trace is the header
+// "RGTR" + version followed by records in the order the scheduler saw them:
+// a BATCH marker for each scheduler round, then that round's requests, and an
+// END record holding the digest of the final schedules.
+struct TraceRecord {
+    uint64_t nanos;    // Arrival time, or round time for BATCH
+    uint64_t sequence; // Hold id for CONFIRM, schedule digest for END
+    int32_t studentId;
+    uint32_t ttlSeconds;
+    uint16_t courseCode;
+    uint8_t kind;
+    uint8_t academicYear;
+    uint8_t isCoreCourse;
+    uint8_t padding[3];
+};
+
+static_assert(sizeof(TraceRecord) == 32, "trace records must stay 32 bytes");
+
+enum TraceRecordKind : uint8_t {
+    TRACE_BATCH = 0,
+    TRACE_REGISTER = 1,
+    TRACE_HOLD = 2,
+    TRACE_CONFIRM = 3,
+    TRACE_END = 4
+};
+
+const char TRACE_MAGIC[4] = { 'R', 'G', 'T', 'R' };
+const uint32_t TRACE_VERSION = 1;
+
+// Appends records to a trace file, buffered so recording stays off the hot path
+class TraceRecorder {
+private:
+    ofstream file;
+    string path;
+    vector<TraceRecord> buffer;
+
+    void append(const TraceRecord& record) {
+        buffer.push_back(record);
+        if (buffer.size() >= 4096) {
+            flush();
+        }
+    }
+
+public:
+    bool open(const string& path) {
+        this->path = path;
+        file.open(path, ios::binary | ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&TRACE_VERSION), sizeof(TRACE_VERSION));
+        buffer.reserve(4096);
+        return flush();
+    }
+
+    const string& getPath() const {
+        return path;
+    }
+
+    // False once any write has failed; the stream stays failed from then on
+    bool good() const {
+        return static_cast<bool>(file);
+    }
+
+    void recordBatch(uint64_t nanos) {
+        TraceRecord record = {};
+        record.kind = TRACE_BATCH;
+        record.nanos = nanos;
+        append(record);
+    }
+
+    void record(const ParsedRegistration& parsed) {
+        TraceRecord record = {};
+        record.nanos = parsed.arrivalNanos;
+        record.studentId = parsed.studentId;
+        record.courseCode = static_cast<uint16_t>(parsed.courseCode);
+        record.academicYear = static_cast<uint8_t>(parsed.academicYear);
+        record.isCoreCourse = parsed.isCoreCourse ? 1 : 0;
+        record.ttlSeconds = static_cast<uint32_t>(parsed.ttlSeconds);
+        if (parsed.command == "CONFIRM") {
+            record.kind = TRACE_CONFIRM;
+            record.sequence = parsed.holdId;
+        }
+        else {
+            record.kind = parsed.command == "HOLD" ? TRACE_HOLD : TRACE_REGISTER;
+            record.sequence = parsed.sequence;
+        }
+        append(record);
+    }
+
+    // Writes the end record and closes the file. False if anything was lost.
+    bool finish(uint64_t scheduleDigest) {
+        TraceRecord record = {};
+        record.kind = TRACE_END;
+        record.sequence = scheduleDigest;
+        append(record);
+        flush();
+        file.close();
+        return good();
+    }
+
+    bool flush() {
+        if (!buffer.empty()) {
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(TraceRecord));
+            buffer.clear();
+        }
+        file.flush();
+        return good();
+    }
+};
+
+bool loadTrace(const string& path, vector<TraceRecord>& records) {
+    ifstream file(path, ios::binary);
+    char magic[4];
+    uint32_t version = 0;
+    if (!file.read(magic, sizeof(magic)) || !file.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+        memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || version != TRACE_VERSION) {
+        cout << path << " is not a registration trace\n";
+        return false;
+    }
+
+    TraceRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+ParsedRegistration parsedFromTrace(const TraceRecord& record) {
+    ParsedRegistration parsed;
+    parsed.loopIndex = -1;
+    parsed.connectionId = 0;
+    parsed.arrivalNanos = record.nanos;
+    parsed.sequence = record.kind == TRACE_CONFIRM ? 0 : record.sequence;
+    parsed.command = record.kind == TRACE_CONFIRM ? "CONFIRM" : (record.kind == TRACE_HOLD ? "HOLD" : "REGISTER");
+    parsed.studentId = record.studentId;
+    parsed.academicYear = record.academicYear;
+    parsed.courseCode = record.courseCode;
+    parsed.isCoreCourse = record.isCoreCourse != 0;
+    parsed.ttlSeconds = static_cast<int>(record.ttlSeconds);
+    parsed.holdId = record.kind == TRACE_CONFIRM ? record.sequence : 0;
+    return parsed;
+}
+
+// Runs the recorded scheduler rounds through processor, sleeping until each
+// round's recorded time when paced. Returns how many requests were fed.
+long long feedTrace(const vector<TraceRecord>& records, RegistrationProcessor& processor, bool paced,
+    const function<void(const ParsedRegistration&, const string&)>& respond) {
+    vector<ParsedRegistration> batch;
+    bool inBatch = false;
+    uint64_t batchNanos = 0;
+    long long requests = 0;
+    auto started = chrono::steady_clock::now();
+
+    for (size_t i = 0; i <= records.size(); i++) {
+        bool atEnd = i == records.size();
+        if (atEnd || records[i].kind == TRACE_BATCH || records[i].kind == TRACE_END) {
+            if (inBatch || !batch.empty()) {
+                if (paced) {
+                    this_thread::sleep_until(started + chrono::nanoseconds(batchNanos));
+                }
+                processor.processBatch(batch, batchNanos / 1000000ULL, respond);
+                requests += batch.size();
+                batch.clear();
+                inBatch = false;
+            }
+            if (!atEnd && records[i].kind == TRACE_BATCH) {
+                inBatch = true;
+                batchNanos = records[i].nanos;
+            }
+        }
+        else {
+            batch.push_back(parsedFromTrace(records[i]));
+        }
+    }
+    return requests;
+}
+
+// Entry point for "replay <traceFile> [paced|fast] [analyticsCsv]". Feeds the recorded rounds into a
+// fresh ScheduleOptimizer, at full speed or at the recorded pacing, then checks
+// the final schedules against the digest stored when the trace was recorded.
+int runTraceReplay(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: replay <traceFile> [paced|fast] [analyticsCsv]\n";
+        return 1;
+    }
+    bool paced = argc > 3 && string(argv[3]) == "paced";
+
+    vector<TraceRecord> records;
+    if (!loadTrace(argv[2], records)) {
+        return 1;
+    }
+
+    vector<Room*> rooms = createCampusRooms();
+    ScheduleOptimizer scheduler(rooms);
+    map<int, Course*> catalogue = createCourseCatalogue();
+
+    bool hasDigest = !records.empty() && records.back().kind == TRACE_END;
+    uint64_t expectedDigest = hasDigest ? records.back().sequence : 0;
+    uint64_t actualDigest = 0;
+    long long requests = 0;
+    long long responses = 0;
+    double seconds = 0;
+    bool exported = true;
+    {
+        RegistrationProcessor processor(scheduler, catalogue);
+        auto countResponse = [&responses](const ParsedRegistration&, const string&) { responses++; };
+
+        auto started = chrono::steady_clock::now();
+        requests = feedTrace(records, processor, paced, countResponse);
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        actualDigest = scheduler.scheduleDigest();
+
+        if (argc > 4 && !scheduler.getAnalytics().exportCsv(argv[4])) {
+            cout << "Could not write " << argv[4] << "\n";
+            exported = false;
+        }
+
+        cout << "Replayed " << requests << " requests (" << responses << " responses) in "
+            << seconds << " s (" << (seconds > 0 ? requests / seconds : 0) << " req/s)\n"
+            << "Enrolled: " << processor.getEnrolled()
+            << ", rejected: " << processor.getRejected()
+            << ", holds expired: " << processor.getHoldsExpired() << "\n";
+    }
+
+    int result = exported ? 0 : 1;
+    if (!hasDigest) {
+        cout << "Trace has no END record, schedules not verified\n";
+    }
+    else if (actualDigest == expectedDigest) {
+        cout << "Final schedules match the recording\n";
+    }
+    else {
+        cout << "Final schedules DIFFER from the recording\n";
+        result = 1;
+    }
+
+    for (auto& course : catalogue) {
+        delete course.second;
+    }
+    for (Room* room : rooms) {
+        delete room;
+    }
+    return result;
+}
+
+// Entry point for "timetables <traceFile> <basePath> [text|csv|json] [cohort|single] [threads]".
+// Rebuilds the term's schedules from a recorded trace and publishes every
+// student's timetable.
+int runTimetableExport(int argc, char* argv[]) {
+    if (argc < 4) {
+        cout << "Usage: timetables <traceFile> <basePath> [text|csv|json] [cohort|single] [threads]\n";
+        return 1;
+    }
+    string formatName = argc > 4 ? argv[4] : "text";
+    TimetableFormat format = formatName == "csv" ? TIMETABLE_CSV : (formatName == "json" ? TIMETABLE_JSON : TIMETABLE_TEXT);
+    bool perCohort = !(argc > 5 && string(argv[5]) == "single");
+    int threadCount = argc > 6 ? atoi(argv[6]) : static_cast<int>(thread::hardware_concurrency());
+
+    vector<TraceRecord> records;
+    if (!loadTrace(argv[2], records)) {
+        return 1;
+    }
+
+    vector<Room*> rooms = createCampusRooms();
+    ScheduleOptimizer scheduler(rooms);
+    map<int, Course*> catalogue = createCourseCatalogue();
+
+    int result = 0;
+    {
+        RegistrationProcessor processor(scheduler, catalogue);
+        feedTrace(records, processor, false, [](const ParsedRegistration&, const string&) {});
+
+        auto started = chrono::steady_clock::now();
+        if (scheduler.exportTimetables(argv[3], format, perCohort, threadCount)) {
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+            cout << "Timetables written in " << seconds << " s\n";
+        }
+        else {
+            cout << "Could not write timetables to " << argv[3] << "\n";
+            result = 1;
+        }
+    }
+
+    for (auto& course : catalogue) {
+        delete course.second;
+    }
+    for (Room* room : rooms) {
+        delete room;
+    }
+    return result;
+}
+
+// Richfield mark records: six lines per student, for example
+//   Student name is: Jody
+//   Student surname is: Bell
+//   Mathematics mark is: 80
+//   Programming mark is: 89
+//   Internet programming mark is: 50
+//   Passed
+// A student passes when every subject reaches PASS_MARK; anyone below
+// AT_RISK_MARK in a subject is flagged for that subject.
+const int PASS_MARK = 50;
+const int AT_RISK_MARK = 60;
+const int GRADE_SUBJECTS = 3;
+const char* const GRADE_SUBJECT_NAMES[GRADE_SUBJECTS] = { "Mathematics", "Programming", "Internet programming" };
+const char* const GRADE_LINE_PREFIXES[GRADE_SUBJECTS] = {
+    "Mathematics mark is: ", "Programming mark is: ", "Internet programming mark is: " };
+
+// Column-oriented mark records. Names point into the loaded file, marks sit in
+// one contiguous array per subject so the evaluation loops vectorize.
+struct GradeTable {
+    vector<string_view> names;
+    vector<string_view> surnames;
+    vector<int32_t> marks[GRADE_SUBJECTS];
+    vector<uint8_t> passed;
+    size_t skippedRecords;
+
+    size_t size() const {
+        return names.size();
+    }
+};
+
+// Aggregates for one subject, mergeable across chunks
+struct SubjectStats {
+    long long sum;
+    int minMark;
+    int maxMark;
+    long long histogram[10]; // 0-9, 10-19, ..., 90-100
+    vector<size_t> atRisk;   // Row indices within the chunk's table
+
+    SubjectStats() {
+        this->sum = 0;
+        this->minMark = INT_MAX;
+        this->maxMark = INT_MIN;
+        for (long long& bucket : histogram) bucket = 0;
+    }
+};
+
+// Reads "<prefix><mark>", false if the line does not match or the mark is not 0..100
+bool parseMarkLine(string_view line, string_view prefix, int32_t& mark) {
+    string_view digits = line.substr(0, prefix.size()) == prefix ? line.substr(prefix.size()) : string_view();
+    if (digits.empty() || digits.size() > 3) {
+        return false;
+    }
+    int value = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    if (value > 100) {
+        return false;
+    }
+    mark = value;
+    return true;
+}
+
+// Parses every record in text into the table. A malformed record is counted once,
+// skipped, and parsing resumes at the next "Student name is:" line.
+void parseGradeRecords(string_view text, GradeTable& table) {
+    const string_view namePrefix = "Student name is: ";
+    const string_view surnamePrefix = "Student surname is: ";
+    table.skippedRecords = 0;
+
+    size_t position = 0;
+    size_t lineStart = 0;
+    auto nextLine = [&text, &position, &lineStart]() {
+        lineStart = position;
+        if (position >= text.size()) return string_view();
+        size_t end = text.find('\n', position);
+        if (end == string_view::npos) end = text.size();
+        string_view line = text.substr(position, end - position);
+        position = end + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        return line;
+    };
+    // Leaves position on the next name line, which may be the one that just failed
+    auto skipToNextRecord = [&]() {
+        position = lineStart;
+        while (position < text.size()) {
+            size_t start = position;
+            if (nextLine().substr(0, namePrefix.size()) == namePrefix) {
+                position = start;
+                return;
+            }
+        }
+    };
+
+    while (position < text.size()) {
+        string_view line = nextLine();
+        if (line.empty()) continue;
+        if (line.substr(0, namePrefix.size()) != namePrefix) {
+            table.skippedRecords++;
+            skipToNextRecord();
+            continue;
+        }
+
+        string_view name = line.substr(namePrefix.size());
+        string_view surname = nextLine();
+        bool valid = surname.substr(0, surnamePrefix.size()) == surnamePrefix;
+        int32_t marks[GRADE_SUBJECTS] = {};
+        for (int subject = 0; valid && subject < GRADE_SUBJECTS; subject++) {
+            valid = parseMarkLine(nextLine(), GRADE_LINE_PREFIXES[subject], marks[subject]);
+        }
+        if (!valid) {
+            table.skippedRecords++;
+            skipToNextRecord();
+            continue;
+        }
+        // A previous verdict is recomputed, not trusted. Files without one are fine.
+        size_t afterMarks = position;
+        string_view verdict = nextLine();
+        if (verdict != "Passed" && verdict != "Failed") {
+            position = afterMarks;
+        }
+
+        table.names.push_back(name);
+        table.surnames.push_back(surname.substr(surnamePrefix.size()));
+        for (int subject = 0; subject < GRADE_SUBJECTS; subject++) {
+            table.marks[subject].push_back(marks[subject]);
+        }
+    }
+}
+
+// Applies the pass rule and accumulates per-subject aggregates over the table
+void evaluateGrades(GradeTable& table, SubjectStats stats[GRADE_SUBJECTS]) {
+    size_t count = table.size();
+    table.passed.assign(count, 1);
+
+    for (int subject = 0; subject < GRADE_SUBJECTS; subject++) {
+        const int32_t* marks = table.marks[subject].data();
+        uint8_t* passed = table.passed.data();
+        long long sum = 0;
+        int minMark = stats[subject].minMark;
+        int maxMark = stats[subject].maxMark;
+
+        // Straight-line loop over one column, no branches for the compiler to trip on
+        for (size_t i = 0; i < count; i++) {
+            int mark = marks[i];
+            sum += mark;
+            minMark = mark < minMark ? mark : minMark;
+            maxMark = mark > maxMark ? mark : maxMark;
+            passed[i] &= static_cast<uint8_t>(mark >= PASS_MARK);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            int bucket = marks[i] / 10;
+            stats[subject].histogram[bucket < 0 ? 0 : (bucket > 9 ? 9 : bucket)]++;
+            if (marks[i] < AT_RISK_MARK) {
+                stats[subject].atRisk.push_back(i);
+            }
+        }
+
+        stats[subject].sum += sum;
+        stats[subject].minMark = minMark;
+        stats[subject].maxMark = maxMark;
+    }
+}
+
+// Writes the table back in the Richfield format with the recomputed verdicts
+void renderGradeRecords(const GradeTable& table, string& out) {
+    out.reserve(out.size() + table.size() * 180);
+    for (size_t i = 0; i < table.size(); i++) {
+        out.append("Student name is: ").append(table.names[i]).append("\n");
+        out.append("Student surname is: ").append(table.surnames[i]).append("\n");
+        for (int subject = 0; subject < GRADE_SUBJECTS; subject++) {
+            out.append(GRADE_LINE_PREFIXES[subject]).append(to_string(table.marks[subject][i])).append("\n");
+        }
+        out.append(table.passed[i] ? "Passed\n" : "Failed\n");
+    }
+}
+
+// Entry point for "grades [input] [output] [threads]". The input is split into
+// chunks on record boundaries; each thread parses, evaluates and renders its own
+// chunk, then results are merged and written in input order.
+int runGradeProcessing(int argc, char* argv[]) {
+    string inputPath = argc > 2 ? argv[2] : "Richfield.txt";
+    string outputPath = argc > 3 ? argv[3] : "Richfield_results.txt";
+    int threadCount = argc > 4 ? atoi(argv[4]) : static_cast<int>(thread::hardware_concurrency());
+    if (threadCount < 1) threadCount = 1;
+
+    ifstream input(inputPath, ios::binary);
+    if (!input) {
+        cout << "Could not open " << inputPath << "\n";
+        return 1;
+    }
+    string contents((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+    string_view text(contents);
+
+    auto started = chrono::steady_clock::now();
+
+    // Chunk boundaries always fall at the start of a "Student name is:" line
+    vector<size_t> boundaries = { 0 };
+    for (int t = 1; t < threadCount; t++) {
+        size_t from = max(boundaries.back(), text.size() * t / threadCount);
+        size_t next = text.find("\nStudent name is: ", from == 0 ? 0 : from - 1);
+        if (next == string_view::npos) break;
+        if (next + 1 > boundaries.back()) boundaries.push_back(next + 1);
+    }
+    boundaries.push_back(text.size());
+
+    size_t chunkCount = boundaries.size() - 1;
+    vector<GradeTable> tables(chunkCount);
+    vector<vector<SubjectStats>> chunkStats(chunkCount, vector<SubjectStats>(GRADE_SUBJECTS));
+    vector<string> rendered(chunkCount);
+
+    vector<thread> workers;
+    for (size_t c = 0; c < chunkCount; c++) {
+        workers.push_back(thread([&, c]() {
+            parseGradeRecords(text.substr(boundaries[c], boundaries[c + 1] - boundaries[c]), tables[c]);
+            evaluateGrades(tables[c], chunkStats[c].data());
+            renderGradeRecords(tables[c], rendered[c]);
+        }));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    SubjectStats totals[GRADE_SUBJECTS];
+    size_t students = 0;
+    size_t passed = 0;
+    size_t skipped = 0;
+    for (size_t c = 0; c < chunkCount; c++) {
+        students += tables[c].size();
+        skipped += tables[c].skippedRecords;
+        for (uint8_t verdict : tables[c].passed) passed += verdict;
+        for (int subject = 0; subject < GRADE_SUBJECTS; subject++) {
+            const SubjectStats& part = chunkStats[c][subject];
+            totals[subject].sum += part.sum;
+            totals[subject].minMark = min(totals[subject].minMark, part.minMark);
+            totals[subject].maxMark = max(totals[subject].maxMark, part.maxMark);
+            for (int b = 0; b < 10; b++) totals[subject].histogram[b] += part.histogram[b];
+        }
+    }
+
+    ofstream output(outputPath, ios::binary | ios::trunc);
+    for (const string& chunk : rendered) {
+        output.write(chunk.data(), chunk.size());
+    }
+    output.close();
+    if (!output) {
+        cout << "Could not write " << outputPath << "\n";
+        return 1;
+    }
+
+    string atRiskPath = outputPath + ".at_risk.csv";
+    ofstream atRisk(atRiskPath, ios::binary | ios::trunc);
+    string atRiskRows = "name,surname,subject,mark\n";
+    for (size_t c = 0; c < chunkCount; c++) {
+        for (int subject = 0; subject < GRADE_SUBJECTS; subject++) {
+            for (size_t row : chunkStats[c][subject].atRisk) {
+                atRiskRows.append(tables[c].names[row]).append(",").append(tables[c].surnames[row])
+                    .append(",").append(GRADE_SUBJECT_NAMES[subject])
+                    .append(",").append(to_string(tables[c].marks[subject][row])).append("\n");
+            }
+        }
+    }
+    atRisk.write(atRiskRows.data(), atRiskRows.size());
+    atRisk.close();
+    if (!atRisk) {
+        cout << "Could not write " << atRiskPath << "\n";
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    cout << "Processed " << students << " students in " << seconds << " s using "
+        << chunkCount << " threads (" << skipped << " malformed records skipped)\n"
+        << "Passed: " << passed << ", Failed: " << students - passed << "\n";
+    for (int subject = 0; subject < GRADE_SUBJECTS && students > 0; subject++) {
+        const SubjectStats& stats = totals[subject];
+        long long atRiskCount = 0;
+        for (size_t c = 0; c < chunkCount; c++) atRiskCount += chunkStats[c][subject].atRisk.size();
+
+        cout << "\n" << GRADE_SUBJECT_NAMES[subject] << "\n"
+            << "  Average: " << static_cast<double>(stats.sum) / students
+            << "  Min: " << stats.minMark << "  Max: " << stats.maxMark << "\n"
+            << "  At risk (below " << AT_RISK_MARK << "): " << atRiskCount << "\n"
+            << "  Distribution:";
+        for (int b = 0; b < 10; b++) {
+            cout << " " << b * 10 << "-" << (b == 9 ? 100 : b * 10 + 9) << ":" << stats.histogram[b];
+        }
+        cout << "\n";
+    }
+    cout << "\nResults written to " << outputPath << ", at-risk list to " << atRiskPath << "\n";
+    return 0;
+}
+
+#ifdef __linux__
+
+// Set by SIGINT/SIGTERM so the server and its threads can shut down cleanly
+atomic<bool> serverStopRequested(false);
+
+void handleServerStopSignal(int) {
+    serverStopRequested = true;
+}
+
+// Thousands of sessions need more descriptors than the usual soft limit of 1024
+void raiseDescriptorLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+class RegistrationServer;
+
+// Owns a share of the client sessions and multiplexes them with epoll
+class SessionLoop {
+private:
+    struct Session {
+        int fd;
+        string inBuffer;
+        string outBuffer;
+        uint32_t events;  // Currently registered with epoll
+        bool closing;     // Peer half-closed or misbehaved: stop reading, close once answered
+        int outstanding;  // Requests submitted whose responses have not arrived yet
+    };
+
+    static const uint64_t LISTEN_ID = 0;
+    static const uint64_t WAKE_ID = 1;
+    // No protocol line comes close; anything longer is a client that never sends '\n'
+    static const size_t MAX_LINE_LENGTH = 256;
+
+    int loopIndex;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    uint64_t nextConnectionId;
+    map<uint64_t, Session> sessions;
+    RegistrationServer* server;
+
+    // Responses posted by the scheduler thread, delivered on this loop's thread
+    mutex outboxMutex;
+    vector<pair<uint64_t, string>> outbox;
+
+    void acceptSessions();
+    void readSession(uint64_t id);
+    void parseLines(uint64_t id, Session& session, vector<ParsedRegistration>& parsed);
+    void flushSession(uint64_t id);
+    void closeSession(uint64_t id);
+    void deliverOutbox();
+
+public:
+    SessionLoop(int loopIndex, int listenFd, RegistrationServer* server);
+    ~SessionLoop();
+
+    // Queue a response line for a session, callable from any thread
+    void post(uint64_t connectionId, const string& line);
+
+    void run();
+};
+
+class RegistrationServer {
+private:
+    ScheduleOptimizer& scheduler;
+    RegistrationProcessor processor;
+    TraceRecorder* recorder;
+    bool recordingFailed;
+    string socketPath;
+    int listenFd;
+    vector<SessionLoop*> loops;
+    chrono::steady_clock::time_point startedAt;
+
+    mutex inboxMutex;
+    condition_variable inboxReady;
+    vector<ParsedRegistration> inbox;
+
+    atomic<long long> sessionsOpened;
+
+    // Drains submitted requests in RegistrationRequest priority order. This is the
+    // only thread that touches the ScheduleOptimizer, so it needs no locking.
+    void runScheduler() {
+        vector<ParsedRegistration> batch;
+        uint64_t nextSequence = 1;
+        auto respond = [this](const ParsedRegistration& parsed, const string& response) {
+            loops[parsed.loopIndex]->post(parsed.connectionId, response);
+        };
+
+        while (!serverStopRequested) {
+            {
+                unique_lock<mutex> lock(inboxMutex);
+                inboxReady.wait_for(lock, chrono::milliseconds(100),
+                    [this]() { return !inbox.empty() || serverStopRequested; });
+                batch.swap(inbox);
+            }
+
+            // Idle rounds only matter while holds can still expire
+            if (batch.empty() && scheduler.getPendingHolds() == 0) continue;
+
+            uint64_t nowNanos = elapsedNanos();
+            for (ParsedRegistration& parsed : batch) {
+                parsed.sequence = nextSequence++;
+            }
+            if (recorder != nullptr) {
+                recorder->recordBatch(nowNanos);
+                for (const ParsedRegistration& parsed : batch) {
+                    recorder->record(parsed);
+                }
+                if (!recordingFailed && !recorder->good()) {
+                    cout << "Could not write trace file " << recorder->getPath() << "\n";
+                    recordingFailed = true;
+                }
+            }
+
+            // Hold ticks are milliseconds since the server started
+            processor.processBatch(batch, nowNanos / 1000000ULL, respond);
+            batch.clear();
+        }
+
+        if (recorder != nullptr && !recorder->finish(scheduler.scheduleDigest()) && !recordingFailed) {
+            cout << "Could not write trace file " << recorder->getPath() << "\n";
+            recordingFailed = true;
+        }
+    }
+
+public:
+    RegistrationServer(ScheduleOptimizer& scheduler, map<int, Course*>& catalogue, string socketPath,
+        TraceRecorder* recorder)
+        : scheduler(scheduler), processor(scheduler, catalogue) {
+        this->recorder = recorder;
+        this->recordingFailed = false;
+        this->socketPath = socketPath;
+        this->listenFd = -1;
+        this->startedAt = chrono::steady_clock::now();
+        this->sessionsOpened = 0;
+    }
+
+    ~RegistrationServer() {
+        for (SessionLoop* loop : loops) {
+            delete loop;
+        }
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+    }
+
+    // Called from the session loops with every request parsed in one wakeup
+    void submit(vector<ParsedRegistration>& parsed) {
+        {
+            lock_guard<mutex> lock(inboxMutex);
+            inbox.insert(inbox.end(), parsed.begin(), parsed.end());
+        }
+        inboxReady.notify_one();
+    }
+
+    void sessionOpened() {
+        sessionsOpened++;
+    }
+
+    // Monotonic nanoseconds since the server started, safe from any thread
+    uint64_t elapsedNanos() const {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - startedAt).count();
+    }
+
+    bool listen(int backlog) {
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            cout << "socket failed: " << strerror(errno) << "\n";
+            return false;
+        }
+
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+        unlink(socketPath.c_str());
+
+        if (bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 ||
+            ::listen(listenFd, backlog) < 0 || !setNonBlocking(listenFd)) {
+            cout << "Could not listen on " << socketPath << ": " << strerror(errno) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Runs the session loops and the scheduler until SIGINT/SIGTERM
+    // Returns false if the trace could not be written in full
+    bool run(int threadCount) {
+        for (int i = 0; i < threadCount; i++) {
+            loops.push_back(new SessionLoop(i, listenFd, this));
+        }
+
+        vector<thread> threads;
+        for (SessionLoop* loop : loops) {
+            threads.push_back(thread(&SessionLoop::run, loop));
+        }
+        thread schedulerThread(&RegistrationServer::runScheduler, this);
+
+        cout << "Registration server listening on " << socketPath
+            << " with " << threadCount << " session threads\n";
+
+        schedulerThread.join();
+        for (thread& t : threads) {
+            t.join();
+        }
+
+        cout << "\nSessions opened: " << sessionsOpened
+            << "\nEnrolled: " << processor.getEnrolled()
+            << "\nRejected: " << processor.getRejected()
+            << "\nHolds expired: " << processor.getHoldsExpired()
+            << "\nRoom slots booked: " << scheduler.getAnalytics().getBookedSlots()
+            << "\nWasted seats: " << scheduler.getAnalytics().getWastedSeats() << "\n";
+        return !recordingFailed;
+    }
+};
+
+SessionLoop::SessionLoop(int loopIndex, int listenFd, RegistrationServer* server) {
+    this->loopIndex = loopIndex;
+    this->listenFd = listenFd;
+    this->server = server;
+    this->nextConnectionId = 2;
+    this->epollFd = epoll_create1(0);
+    this->wakeFd = eventfd(0, EFD_NONBLOCK);
+
+    // Every loop waits on the shared listening socket, EPOLLEXCLUSIVE wakes only one
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.u64 = LISTEN_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_ID;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+}
+
+SessionLoop::~SessionLoop() {
+    for (auto& session : sessions) {
+        close(session.second.fd);
+    }
+    close(wakeFd);
+    close(epollFd);
+}
+
+void SessionLoop::post(uint64_t connectionId, const string& line) {
+    {
+        lock_guard<mutex> lock(outboxMutex);
+        outbox.push_back({ connectionId, line });
+    }
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+void SessionLoop::acceptSessions() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (fd < 0) {
+            return; // EAGAIN, or another loop took the connection
+        }
+
+        uint64_t id = nextConnectionId++;
+        sessions[id] = { fd, "", "", EPOLLIN, false, 0 };
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        server->sessionOpened();
+    }
+}
+
+void SessionLoop::readSession(uint64_t id) {
+    Session& session = sessions[id];
+    char buffer[4096];
+    vector<ParsedRegistration> parsed;
+
+    while (!session.closing) {
+        ssize_t count = read(session.fd, buffer, sizeof(buffer));
+        if (count > 0) {
+            session.inBuffer.append(buffer, count);
+            parseLines(id, session, parsed);
+            continue;
+        }
+        if (count == 0) {
+            // Half-close: the lines already sent still get their answers
+            session.closing = true;
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        closeSession(id);
+        return;
+    }
+
+    if (!parsed.empty()) {
+        session.outstanding += static_cast<int>(parsed.size());
+        server->submit(parsed);
+    }
+    flushSession(id);
+}
+
+void SessionLoop::parseLines(uint64_t id, Session& session, vector<ParsedRegistration>& parsed) {
+    size_t start = 0;
+    size_t newline;
+    while ((newline = session.inBuffer.find('\n', start)) != string::npos) {
+        ParsedRegistration request;
+        if (newline - start > MAX_LINE_LENGTH) {
+            session.outBuffer += "ERROR line too long\n";
+        }
+        else if (parseRegistrationLine(session.inBuffer.substr(start, newline - start), request)) {
+            request.loopIndex = loopIndex;
+            request.connectionId = id;
+            request.arrivalNanos = server->elapsedNanos();
+            parsed.push_back(request);
+        }
+        else {
+            session.outBuffer += "ERROR malformed request\n";
+        }
+        start = newline + 1;
+    }
+    session.inBuffer.erase(0, start);
+
+    if (session.inBuffer.size() > MAX_LINE_LENGTH) {
+        session.outBuffer += "ERROR line too long\n";
+        session.inBuffer.clear();
+        session.closing = true;
+    }
+}
+
+void SessionLoop::flushSession(uint64_t id) {
+    Session& session = sessions[id];
+    while (!session.outBuffer.empty()) {
+        ssize_t count = write(session.fd, session.outBuffer.data(), session.outBuffer.size());
+        if (count < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeSession(id);
+            return;
+        }
+        session.outBuffer.erase(0, count);
+    }
+
+    if (session.closing && session.outstanding == 0 && session.outBuffer.empty()) {
+        closeSession(id);
+        return;
+    }
+
+    // Read until the session starts closing, ask for EPOLLOUT only while output is pending
+    uint32_t events = (session.closing ? 0u : static_cast<uint32_t>(EPOLLIN)) |
+        (session.outBuffer.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    if (events != session.events) {
+        epoll_event event;
+        event.events = events;
+        event.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
+        session.events = events;
+    }
+}
+
+void SessionLoop::closeSession(uint64_t id) {
+    auto it = sessions.find(id);
+    if (it != sessions.end()) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        sessions.erase(it);
+    }
+}
+
+void SessionLoop::deliverOutbox() {
+    uint64_t counter;
+    ssize_t readCount = read(wakeFd, &counter, sizeof(counter));
+    (void)readCount;
+
+    vector<pair<uint64_t, string>> responses;
+    {
+        lock_guard<mutex> lock(outboxMutex);
+        responses.swap(outbox);
+    }
+
+    vector<uint64_t> touched;
+    for (auto& response : responses) {
+        auto it = sessions.find(response.first);
+        if (it == sessions.end()) continue; // Session closed while its request was queued
+        if (it->second.outBuffer.empty()) touched.push_back(response.first);
+        it->second.outBuffer += response.second;
+        it->second.outstanding--;
+    }
+    for (uint64_t id : touched) {
+        if (sessions.find(id) != sessions.end()) {
+            flushSession(id);
+        }
+    }
+}
+
+void SessionLoop::run() {
+    epoll_event events[256];
+    while (!serverStopRequested) {
+        int count = epoll_wait(epollFd, events, 256, 200);
+        for (int i = 0; i < count; i++) {
+            uint64_t id = events[i].data.u64;
+            if (id == LISTEN_ID) {
+                acceptSessions();
+            }
+            else if (id == WAKE_ID) {
+                deliverOutbox();
+            }
+            else if (sessions.find(id) != sessions.end()) {
+                if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                    closeSession(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLIN) readSession(id);
+                if ((events[i].events & EPOLLOUT) && sessions.find(id) != sessions.end()) flushSession(id);
+            }
+        }
+    }
+}
+
+// Entry point for "serve [socketPath] [threads] [traceFile]"
+int runRegistrationServer(int argc, char* argv[]) {
+    string socketPath = argc > 2 ? argv[2] : "/tmp/registration.sock";
+    int threadCount = argc > 3 ? atoi(argv[3]) : 4;
+    if (threadCount < 1) threadCount = 1;
+
+    TraceRecorder recorder;
+    bool recording = argc > 4;
+    if (recording && !recorder.open(argv[4])) {
+        cout << "Could not create trace file " << argv[4] << "\n";
+        return 1;
+    }
+
+    raiseDescriptorLimit();
+    signal(SIGINT, handleServerStopSignal);
+    signal(SIGTERM, handleServerStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    vector<Room*> rooms = createCampusRooms();
+    ScheduleOptimizer scheduler(rooms);
+
+    map<int, Course*> catalogue = createCourseCatalogue();
+
+    int result = 0;
+    {
+        RegistrationServer server(scheduler, catalogue, socketPath, recording ? &recorder : nullptr);
+        if (server.listen(4096)) {
+            result = server.run(threadCount) ? 0 : 1;
+        }
+        else {
+            result = 1;
+        }
+    }
+
+    for (auto& course : catalogue) {
+        delete course.second;
+    }
+    for (Room* room : rooms) {
+        delete room;
+    }
+    return result;
+}
+
+// Client side of one load generator session
+struct LoadSession {
+    int fd;
+    int studentId;
+    int academicYear;
+    int remaining;
+    string inBuffer;
+    chrono::steady_clock::time_point sentAt;
+};
+
+bool sendLoadRequest(LoadSession& session) {
+    int courseCode = session.academicYear * 100 + 1 + (session.remaining % 5);
+    string line = "REGISTER " + to_string(session.studentId) + " "
+        + to_string(session.academicYear) + " " + to_string(courseCode) + " "
+        + (session.academicYear == 1 ? "1" : "0") + "\n";
+    session.sentAt = chrono::steady_clock::now();
+    session.remaining--;
+    // Requests are a few dozen bytes, so a non-blocking write will not be partial
+    return write(session.fd, line.data(), line.size()) == (ssize_t)line.size();
+}
+
+// Drives its share of sessions closed-loop: one outstanding request per session
+void runLoadWorker(string socketPath, int firstStudent, int sessionCount, int requestsPerSession,
+    vector<double>* latencies, int* failures) {
+    int epollFd = epoll_create1(0);
+    vector<LoadSession> sessions(sessionCount);
+    int active = 0;
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    for (int i = 0; i < sessionCount; i++) {
+        LoadSession& session = sessions[i];
+        session.studentId = firstStudent + i;
+        session.academicYear = (session.studentId % 3) + 1;
+        session.remaining = requestsPerSession;
+        session.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (session.fd < 0 || connect(session.fd, (sockaddr*)&address, sizeof(address)) < 0) {
+            (*failures)++;
+            if (session.fd >= 0) close(session.fd);
+            session.fd = -1;
+            continue;
+        }
+        setNonBlocking(session.fd);
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, session.fd, &event);
+        active++;
+    }
+
+    for (LoadSession& session : sessions) {
+        if (session.fd >= 0 && session.remaining > 0) sendLoadRequest(session);
+    }
+
+    epoll_event events[256];
+    char buffer[4096];
+    while (active > 0) {
+        int count = epoll_wait(epollFd, events, 256, 5000);
+        if (count <= 0) {
+            (*failures) += active; // Server stopped answering
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            LoadSession& session = sessions[events[i].data.u32];
+            ssize_t readCount = read(session.fd, buffer, sizeof(buffer));
+            if (readCount <= 0) {
+                if (readCount < 0 && errno == EAGAIN) continue;
+                (*failures)++;
+                close(session.fd);
+                active--;
+                continue;
+            }
+            session.inBuffer.append(buffer, readCount);
+
+            size_t newline;
+            while ((newline = session.inBuffer.find('\n')) != string::npos) {
+                session.inBuffer.erase(0, newline + 1);
+                latencies->push_back(chrono::duration<double, micro>(
+                    chrono::steady_clock::now() - session.sentAt).count());
+
+                if (session.remaining > 0) {
+                    sendLoadRequest(session);
+                }
+                else {
+                    close(session.fd);
+                    active--;
+                }
+            }
+        }
+    }
+    close(epollFd);
+}
+
+// Entry point for "loadgen [socketPath] [sessions] [requestsPerSession] [threads]"
+int runLoadGenerator(int argc, char* argv[]) {
+    string socketPath = argc > 2 ? argv[2] : "/tmp/registration.sock";
+    int sessionCount = argc > 3 ? atoi(argv[3]) : 2000;
+    int requestsPerSession = argc > 4 ? atoi(argv[4]) : 5;
+    int threadCount = argc > 5 ? atoi(argv[5]) : 4;
+    if (threadCount < 1) threadCount = 1;
+
+    raiseDescriptorLimit();
+    signal(SIGPIPE, SIG_IGN);
+
+    vector<vector<double>> latencies(threadCount);
+    vector<int> failures(threadCount, 0);
+    vector<thread> threads;
+
+    auto start = chrono::steady_clock::now();
+    int firstStudent = 1;
+    for (int i = 0; i < threadCount; i++) {
+        int share = sessionCount / threadCount + (i < sessionCount % threadCount ? 1 : 0);
+        threads.push_back(thread(runLoadWorker, socketPath, firstStudent, share, requestsPerSession,
+            &latencies[i], &failures[i]));
+        firstStudent += share;
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> all;
+    int failed = 0;
+    for (int i = 0; i < threadCount; i++) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        failed += failures[i];
+    }
+    if (all.empty()) {
+        cout << "No responses received (" << failed << " failed sessions)\n";
+        return 1;
+    }
+    sort(all.begin(), all.end());
+
+    cout << "Sessions: " << sessionCount << ", failed: " << failed << "\n"
+        << "Responses: " << all.size() << " in " << seconds << " s ("
+        << all.size() / seconds << " req/s)\n"
+        << "Latency p50: " << all[all.size() / 2] << " us\n"
+        << "Latency p99: " << all[(all.size() * 99) / 100] << " us\n"
+        << "Latency max: " << all.back() << " us\n";
+    return failed == 0 ? 0 : 1;
+}
+
+// Sharded scheduling: one worker process per academic year. Students and the
+// courses they request are grouped so that each student and each course lives in
+// exactly one shard, keyed by the year of the group's first student. Every room
+// slot is owned by exactly one shard; a shard blocks the slots it does not own in
+// its own ScheduleOptimizer, so shards never double-book a room. Between rounds
+// the parent hands unused slots to shards with courses that found no room, and
+// those shards rerun only the requests that were waiting on such a course.
+// All coordination goes through one anonymous shared mapping.
+const int MAX_SHARDS = 8;
+const int MAX_SHARD_ROOMS = 64;
+const int MAX_SHARD_COURSES = 64;
+const int MAX_SHARD_ENROLLMENTS = MAX_SHARD_COURSES * 64;
+
+struct ShardPlacement {
+    int32_t courseCode;
+    int32_t roomIndex;
+    int32_t slot;
+    int32_t enrolled;
+};
+
+struct ShardEnrollment {
+    int32_t studentId;
+    int32_t courseCode;
+    int32_t slot;
+};
+
+struct ShardReport {
+    int32_t requests;
+    int32_t enrolled;
+    int32_t rejected;
+    int32_t rerun;
+    int32_t placementCount;
+    ShardPlacement placements[MAX_SHARD_COURSES];
+    int32_t unplacedCount;
+    int32_t unplacedCourses[MAX_SHARD_COURSES];
+    int32_t enrollmentCount;
+    ShardEnrollment enrollments[MAX_SHARD_ENROLLMENTS];
+};
+
+struct ShardSharedState {
+    sem_t roundDone;
+    sem_t roundStart[MAX_SHARDS];
+    int32_t finished;
+    int8_t owner[MAX_SHARD_ROOMS][SLOTS_PER_WEEK];
+    uint8_t used[MAX_SHARD_ROOMS][SLOTS_PER_WEEK];
+    ShardReport reports[MAX_SHARDS];
+};
+
+// Worker side: schedule one shard's requests inside its room-slot partition
+void runShardWorker(int shard, ShardSharedState* shared, const vector<TraceRecord>& records) {
+    vector<Room*> rooms = createCampusRooms();
+    ScheduleOptimizer scheduler(rooms);
+    map<int, Course*> catalogue = createCourseCatalogue();
+    RegistrationProcessor processor(scheduler, catalogue);
+    ShardReport& report = shared->reports[shard];
+
+    vector<vector<bool>> blocked(rooms.size(), vector<bool>(SLOTS_PER_WEEK, false));
+    auto syncPartition = [&]() {
+        for (size_t r = 0; r < rooms.size(); r++) {
+            for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+                bool mine = shared->owner[r][bit] == shard;
+                if (!mine && !blocked[r][bit]) {
+                    scheduler.blockRoomSlot(rooms[r], slotFromBit(bit));
+                    blocked[r][bit] = true;
+                }
+                else if (mine && blocked[r][bit]) {
+                    scheduler.unblockRoomSlot(rooms[r], slotFromBit(bit));
+                    blocked[r][bit] = false;
+                }
+            }
+        }
+    };
+
+    vector<ParsedRegistration> rejected;
+    auto collectRejected = [&rejected](const ParsedRegistration& parsed, const string& response) {
+        if (response.compare(0, 8, "REJECTED") == 0) {
+            rejected.push_back(parsed);
+        }
+    };
+
+    auto publish = [&]() {
+        report.enrolled = static_cast<int32_t>(processor.getEnrolled());
+        report.rejected = static_cast<int32_t>(rejected.size());
+        report.placementCount = 0;
+        for (const ScheduleEntry& entry : scheduler.getCoursePlacements()) {
+            if (report.placementCount == MAX_SHARD_COURSES) break;
+            int roomIndex = static_cast<int>(find(rooms.begin(), rooms.end(), entry.room) - rooms.begin());
+            report.placements[report.placementCount++] = { entry.course->getCourseCode(), roomIndex,
+                slotBit(entry.timeSlot), scheduler.getEnrollmentCount(entry.course) };
+            shared->used[roomIndex][slotBit(entry.timeSlot)] = 1;
+        }
+        report.enrollmentCount = 0;
+        for (const auto& enrollment : scheduler.getEnrollments()) {
+            if (report.enrollmentCount == MAX_SHARD_ENROLLMENTS) break;
+            report.enrollments[report.enrollmentCount++] = { enrollment.first->getStudentId(),
+                enrollment.second.course->getCourseCode(), slotBit(enrollment.second.timeSlot) };
+        }
+
+        set<int> unplaced;
+        for (const ParsedRegistration& parsed : rejected) {
+            auto course = catalogue.find(parsed.courseCode);
+            if (course != catalogue.end() && scheduler.getEnrollmentCount(course->second) == 0) {
+                unplaced.insert(parsed.courseCode);
+            }
+        }
+        report.unplacedCount = 0;
+        for (int code : unplaced) {
+            if (report.unplacedCount == MAX_SHARD_COURSES) break;
+            report.unplacedCourses[report.unplacedCount++] = code;
+        }
+    };
+
+    syncPartition();
+    report.requests = static_cast<int32_t>(feedTrace(records, processor, false, collectRejected));
+    report.rerun = 0;
+    uint64_t lastTick = 0;
+    for (const TraceRecord& record : records) {
+        if (record.kind == TRACE_BATCH) lastTick = record.nanos / 1000000ULL;
+    }
+    publish();
+    sem_post(&shared->roundDone);
+
+    while (true) {
+        sem_wait(&shared->roundStart[shard]);
+        if (shared->finished) break;
+        syncPartition();
+
+        // Only requests for a course that never found a room can gain from new slots
+        vector<ParsedRegistration> affected;
+        vector<ParsedRegistration> kept;
+        for (const ParsedRegistration& parsed : rejected) {
+            auto course = catalogue.find(parsed.courseCode);
+            if (course != catalogue.end() && scheduler.getEnrollmentCount(course->second) == 0) {
+                affected.push_back(parsed);
+            }
+            else {
+                kept.push_back(parsed);
+            }
+        }
+        rejected.swap(kept);
+        if (!affected.empty()) {
+            processor.processBatch(affected, lastTick, collectRejected);
+            report.rerun += static_cast<int32_t>(affected.size());
+        }
+        publish();
+        sem_post(&shared->roundDone);
+    }
+
+    for (auto& course : catalogue) {
+        delete course.second;
+    }
+    for (Room* room : rooms) {
+        delete room;
+    }
+}
+
+// Wait for one worker to finish its round. Checks every 100 ms that no worker
+// has died, so a crashed shard cannot leave the parent blocked forever. Returns
+// false once a worker is found dead (it is reaped and its pid cleared).
+bool waitForShardRound(ShardSharedState* shared, vector<pid_t>& workers) {
+    while (true) {
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        if (sem_timedwait(&shared->roundDone, &deadline) == 0) {
+            return true;
+        }
+        if (errno != ETIMEDOUT && errno != EINTR) {
+            cout << "sem_timedwait failed: " << strerror(errno) << "\n";
+            return false;
+        }
+
+        for (pid_t& pid : workers) {
+            int status = 0;
+            if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid) {
+                if (WIFSIGNALED(status)) {
+                    cout << "Shard worker " << pid << " killed by signal " << WTERMSIG(status) << "\n";
+                }
+                else {
+                    cout << "Shard worker " << pid << " exited early with status " << WEXITSTATUS(status) << "\n";
+                }
+                pid = 0;
+                return false;
+            }
+        }
+    }
+}
+
+// Entry point for "shard <traceFile> [maxRounds]". Holds are scheduled as plain
+// registrations and confirmations dropped, since hold ids are per process.
+int runShardedScheduling(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: shard <traceFile> [maxRounds]\n";
+        return 1;
+    }
+    int maxRounds = argc > 3 ? atoi(argv[3]) : 8;
+
+    vector<TraceRecord> records;
+    if (!loadTrace(argv[2], records)) {
+        return 1;
+    }
+
+    vector<Room*> rooms = createCampusRooms();
+    map<int, Course*> catalogue = createCourseCatalogue();
+    if (rooms.size() > static_cast<size_t>(MAX_SHARD_ROOMS)) {
+        cout << "Too many rooms for sharded mode\n";
+        return 1;
+    }
+
+    // Group every student with the courses they request, so no student is
+    // scheduled by two shards and no course is placed twice. A group goes to the
+    // shard of its first student's academic year; every round marker goes to all.
+    // Requests RegistrationProcessor would answer with an error are left out, so
+    // they neither pick a shard nor count toward room demand.
+    vector<bool> accepted(records.size(), false);
+    map<int, int> studentYear;
+    for (size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& record = records[i];
+        if ((record.kind != TRACE_REGISTER && record.kind != TRACE_HOLD) ||
+            !isValidAcademicYear(record.academicYear) ||
+            catalogue.find(record.courseCode) == catalogue.end()) {
+            continue;
+        }
+        auto known = studentYear.insert({ record.studentId, record.academicYear });
+        accepted[i] = known.first->second == record.academicYear;
+    }
+    map<int, int> studentNode;
+    map<int, int> courseNode;
+    vector<int> parent;
+    auto node = [&parent](map<int, int>& nodes, int key) {
+        auto found = nodes.find(key);
+        if (found != nodes.end()) return found->second;
+        int created = static_cast<int>(parent.size());
+        parent.push_back(created);
+        nodes[key] = created;
+        return created;
+    };
+    auto root = [&parent](int n) {
+        while (parent[n] != n) {
+            parent[n] = parent[parent[n]];
+            n = parent[n];
+        }
+        return n;
+    };
+    for (size_t i = 0; i < records.size(); i++) {
+        if (!accepted[i]) continue;
+        const TraceRecord& record = records[i];
+        int student = root(node(studentNode, record.studentId));
+        int course = root(node(courseNode, record.courseCode));
+        parent[student] = course;
+    }
+
+    vector<vector<TraceRecord>> shardRecords(MAX_SHARDS);
+    vector<map<int, int>> shardCourses(MAX_SHARDS); // Requests per course
+    vector<int> recordShard(records.size(), -1);
+    map<int, int> groupShard;
+    for (size_t i = 0; i < records.size(); i++) {
+        const TraceRecord& record = records[i];
+        if (record.kind == TRACE_BATCH) {
+            for (vector<TraceRecord>& shard : shardRecords) shard.push_back(record);
+        }
+        else if (accepted[i]) {
+            int group = root(studentNode[record.studentId]);
+            if (groupShard.find(group) == groupShard.end()) {
+                groupShard[group] = record.academicYear - 1;
+            }
+            int shard = groupShard[group];
+            TraceRecord registration = record;
+            registration.kind = TRACE_REGISTER;
+            registration.ttlSeconds = 0;
+            shardRecords[shard].push_back(registration);
+            shardCourses[shard][record.courseCode]++;
+            recordShard[i] = shard;
+        }
+    }
+    vector<int> shards;
+    for (int shard = 0; shard < MAX_SHARDS; shard++) {
+        if (!shardCourses[shard].empty()) shards.push_back(shard);
+    }
+
+    ShardSharedState* shared = static_cast<ShardSharedState*>(mmap(nullptr, sizeof(ShardSharedState),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if (shared == MAP_FAILED) {
+        cout << "mmap failed: " << strerror(errno) << "\n";
+        return 1;
+    }
+    memset(shared, 0, sizeof(ShardSharedState));
+    sem_init(&shared->roundDone, 1, 0);
+    for (int shard = 0; shard < MAX_SHARDS; shard++) {
+        sem_init(&shared->roundStart[shard], 1, 0);
+    }
+    memset(shared->owner, -1, sizeof(shared->owner));
+
+    // Pre-negotiated partition: each room's slots are dealt out in proportion to
+    // how many of a shard's requests that room suits, interleaved across the week.
+    // A shard with few requests spread over many courses can come up short, which
+    // is what the rebalance rounds are for.
+    for (size_t r = 0; r < rooms.size(); r++) {
+        vector<int> demand(MAX_SHARDS, 0);
+        int totalDemand = 0;
+        for (int shard : shards) {
+            for (const auto& course : shardCourses[shard]) {
+                if (isRoomSuitable(rooms[r], catalogue[course.first])) demand[shard] += course.second;
+            }
+            totalDemand += demand[shard];
+        }
+        if (totalDemand == 0) continue;
+
+        vector<double> credit(MAX_SHARDS, 0);
+        for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+            int best = -1;
+            for (int shard : shards) {
+                credit[shard] += static_cast<double>(demand[shard]) / totalDemand;
+                if (demand[shard] > 0 && (best < 0 || credit[shard] > credit[best])) best = shard;
+            }
+            credit[best] -= 1;
+            shared->owner[r][bit] = static_cast<int8_t>(best);
+        }
+    }
+
+    vector<pid_t> workers;
+    auto release = [&]() {
+        sem_destroy(&shared->roundDone);
+        for (int shard = 0; shard < MAX_SHARDS; shard++) {
+            sem_destroy(&shared->roundStart[shard]);
+        }
+        munmap(shared, sizeof(ShardSharedState));
+        for (auto& course : catalogue) {
+            delete course.second;
+        }
+        for (Room* room : rooms) {
+            delete room;
+        }
+    };
+    // Tell every worker still running to stop, then reap them all
+    auto stopWorkers = [&]() {
+        shared->finished = 1;
+        for (int shard : shards) {
+            sem_post(&shared->roundStart[shard]);
+        }
+        for (pid_t pid : workers) {
+            if (pid > 0) waitpid(pid, nullptr, 0);
+        }
+    };
+
+    auto started = chrono::steady_clock::now();
+    for (int shard : shards) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            runShardWorker(shard, shared, shardRecords[shard]);
+            _exit(0);
+        }
+        if (pid < 0) {
+            cout << "fork failed: " << strerror(errno) << "\n";
+            stopWorkers();
+            release();
+            return 1;
+        }
+        workers.push_back(pid);
+    }
+
+    // Rebalance: after each round hand unused slots to shards with unplaced courses
+    int round = 0;
+    int traded = 0;
+    while (true) {
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (!waitForShardRound(shared, workers)) {
+                stopWorkers();
+                release();
+                return 1;
+            }
+        }
+
+        int tradedThisRound = 0;
+        if (round < maxRounds) {
+            for (int shard : shards) {
+                const ShardReport& report = shared->reports[shard];
+                for (int i = 0; i < report.unplacedCount; i++) {
+                    Course* course = catalogue[report.unplacedCourses[i]];
+                    int bestRoom = -1;
+                    int bestSlot = -1;
+                    int minWastedSpace = INT_MAX;
+                    for (size_t r = 0; r < rooms.size(); r++) {
+                        if (!isRoomSuitable(rooms[r], course)) continue;
+                        for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+                            int owner = shared->owner[r][bit];
+                            if (owner != shard && !shared->used[r][bit] &&
+                                rooms[r]->getCapacity() - course->getMaxCapacity() < minWastedSpace) {
+                                minWastedSpace = rooms[r]->getCapacity() - course->getMaxCapacity();
+                                bestRoom = static_cast<int>(r);
+                                bestSlot = bit;
+                            }
+                        }
+                    }
+                    if (bestRoom >= 0) {
+                        // Marked used so no other shard is handed it this round
+                        shared->owner[bestRoom][bestSlot] = static_cast<int8_t>(shard);
+                        shared->used[bestRoom][bestSlot] = 1;
+                        tradedThisRound++;
+                    }
+                }
+            }
+        }
+
+        traded += tradedThisRound;
+        if (tradedThisRound == 0) {
+            shared->finished = 1;
+        }
+        else {
+            // Slots given away but not taken up are free again for the next round
+            memset(shared->used, 0, sizeof(shared->used));
+            round++;
+        }
+        for (int shard : shards) {
+            sem_post(&shared->roundStart[shard]);
+        }
+        if (shared->finished) break;
+    }
+
+    for (pid_t pid : workers) {
+        waitpid(pid, nullptr, 0);
+    }
+    // Merge: every placement must sit in a slot its shard owns, no room slot or
+    // course may be booked by two shards and no student may have two classes at
+    // once across shards. Shards that clash are merged into one and rerun here.
+    auto findConflicts = [&](int& conflicts) {
+        set<int> clashing;
+        conflicts = 0;
+        vector<vector<int>> booked(rooms.size(), vector<int>(SLOTS_PER_WEEK, -1));
+        map<int, int> placedBy;
+        map<pair<int, int>, int> studentSlots;
+        for (int shard : shards) {
+            const ShardReport& report = shared->reports[shard];
+            for (int i = 0; i < report.placementCount; i++) {
+                const ShardPlacement& placement = report.placements[i];
+                int& bookedBy = booked[placement.roomIndex][placement.slot];
+                if (bookedBy >= 0 || shared->owner[placement.roomIndex][placement.slot] != shard) {
+                    conflicts++;
+                    clashing.insert(shard);
+                    if (bookedBy >= 0) clashing.insert(bookedBy);
+                }
+                bookedBy = shard;
+                auto placed = placedBy.insert({ placement.courseCode, shard });
+                if (!placed.second) {
+                    conflicts++;
+                    clashing.insert(shard);
+                    clashing.insert(placed.first->second);
+                }
+            }
+            for (int i = 0; i < report.enrollmentCount; i++) {
+                const ShardEnrollment& enrollment = report.enrollments[i];
+                auto taken = studentSlots.insert({ { enrollment.studentId, enrollment.slot }, shard });
+                if (!taken.second && taken.first->second != shard) {
+                    conflicts++;
+                    clashing.insert(shard);
+                    clashing.insert(taken.first->second);
+                }
+            }
+        }
+        return clashing;
+    };
+
+    int conflicts = 0;
+    int mergedShards = 0;
+    set<int> clashing = findConflicts(conflicts);
+    while (clashing.size() > 1) {
+        int target = *clashing.begin();
+        for (size_t r = 0; r < rooms.size(); r++) {
+            for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+                if (clashing.count(shared->owner[r][bit])) shared->owner[r][bit] = static_cast<int8_t>(target);
+            }
+        }
+        vector<TraceRecord> merged;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (records[i].kind == TRACE_BATCH) {
+                merged.push_back(records[i]);
+            }
+            else if (clashing.count(recordShard[i])) {
+                TraceRecord registration = records[i];
+                registration.kind = TRACE_REGISTER;
+                registration.ttlSeconds = 0;
+                merged.push_back(registration);
+                recordShard[i] = target;
+            }
+        }
+        for (int shard : clashing) {
+            memset(&shared->reports[shard], 0, sizeof(ShardReport));
+        }
+        shards.erase(remove_if(shards.begin(), shards.end(),
+            [&clashing, target](int shard) { return shard != target && clashing.count(shard); }), shards.end());
+        mergedShards += static_cast<int>(clashing.size()) - 1;
+
+        // Already finished, so the worker schedules once and returns
+        sem_post(&shared->roundStart[target]);
+        runShardWorker(target, shared, merged);
+        clashing = findConflicts(conflicts);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    int totalEnrolled = 0;
+    int totalRejected = 0;
+    for (int shard : shards) {
+        const ShardReport& report = shared->reports[shard];
+        totalEnrolled += report.enrolled;
+        totalRejected += report.rejected;
+
+        int owned = 0;
+        for (size_t r = 0; r < rooms.size(); r++) {
+            for (int bit = 0; bit < SLOTS_PER_WEEK; bit++) {
+                if (shared->owner[r][bit] == shard) owned++;
+            }
+        }
+        cout << "Year " << shard + 1 << " shard: " << report.requests << " requests, "
+            << report.enrolled << " enrolled, " << report.rejected << " rejected, "
+            << report.placementCount << " courses placed, " << report.unplacedCount << " unplaced, "
+            << owned << " room slots owned, " << report.rerun << " requests rerun\n";
+    }
+    cout << "Rebalance rounds: " << round << ", room slots traded: " << traded << "\n"
+        << "Total enrolled: " << totalEnrolled << ", rejected: " << totalRejected
+        << ", conflicts: " << conflicts << ", shards merged and rerun: " << mergedShards << "\n"
+        << "Completed in " << seconds << " s\n";
+
+    release();
+    return conflicts == 0 ? 0 : 1;
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "clubs") {
+        return runClubMeetingPlanner(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "replay") {
+        return runTraceReplay(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "grades") {
+        return runGradeProcessing(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "timetables") {
+        return runTimetableExport(argc, argv);
+    }
+#ifdef __linux__
+    if (argc > 1 && string(argv[1]) == "serve") {
+        return runRegistrationServer(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "loadgen") {
+        return runLoadGenerator(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "shard") {
+        return runShardedScheduling(argc, argv);
+    }
+#endif
+
+    // Create rooms
+    vector<Room*> rooms = createCampusRooms();
 
     // Initialize scheduler
     ScheduleOptimizer scheduler(rooms);
@@ -493,6 +3563,7 @@ int main() {
                 req.course = selectedCourse;
                 req.isCoreCourse = (year == 1);
                 req.timestamp = time(nullptr);
+                req.sequence = regQueue.size();
                 regQueue.push(req);
             }
             else {